@@ -23,7 +23,11 @@
  */
 
 #include <signal.h>
+#include <stdlib.h>
+#include <time.h>
 #include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
 #include "tctest.h"
 
 typedef struct {
@@ -48,6 +52,40 @@ int tctest_num_executed;
 const char *tctest_testname_to_execute;
 void (*tctest_on_test_executed)(const char *testname, int passed);
 void (*tctest_on_complete)(int num_passed, int num_executed);
+double tctest_last_test_seconds;
+int tctest_num_workers;
+
+/*
+ * Result of a test run in a worker process. These live in shared
+ * memory so the worker can report its own timing to the parent.
+ */
+typedef struct {
+	int done;
+	int passed;
+	double seconds;
+} tctest_worker_result;
+
+/* Bookkeeping the parent keeps for each worker slot. */
+typedef struct {
+	pid_t pid;
+	const char *testname;
+	FILE *output;
+} tctest_worker;
+
+static tctest_worker *tctest_workers;
+static tctest_worker_result *tctest_worker_results;
+static int tctest_num_active_workers;
+
+/* slot index in a worker process, -1 in the parent */
+static int tctest_worker_slot = -1;
+
+static double tctest_test_start;
+
+static double tctest_now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
 
 /*
  * Special version of write to work around the fact that
@@ -138,3 +176,140 @@ void tctest_register_signal_handlers(void) {
 		sigaction(tctest_signal_list[i].signum, &sa, NULL);
 	}
 }
+
+static void tctest_report(const char *testname, int passed, double seconds) {
+	if (!passed) {
+		tctest_failures++;
+	}
+	tctest_last_test_seconds = seconds;
+	if (tctest_on_test_executed) {
+		tctest_on_test_executed(testname, passed);
+	}
+}
+
+/*
+ * Wait for one worker to finish, copy its output to stdout,
+ * and report its result.
+ */
+static void tctest_reap_worker(void) {
+	int status;
+	pid_t pid = waitpid(-1, &status, 0);
+	if (pid <= 0) {
+		return;
+	}
+
+	int slot;
+	for (slot = 0; slot < tctest_num_workers; slot++) {
+		if (tctest_workers[slot].pid == pid) {
+			break;
+		}
+	}
+	if (slot == tctest_num_workers) {
+		return;
+	}
+
+	tctest_worker *worker = &tctest_workers[slot];
+	tctest_worker_result *result = &tctest_worker_results[slot];
+
+	/* copy the worker's buffered output */
+	char buf[4096];
+	size_t n;
+	char last = '\n';
+	rewind(worker->output);
+	while ((n = fread(buf, 1, sizeof(buf), worker->output)) > 0) {
+		fwrite(buf, 1, n, stdout);
+		last = buf[n - 1];
+	}
+	fclose(worker->output);
+
+	int passed = result->done && result->passed &&
+		WIFEXITED(status) && WEXITSTATUS(status) == 0;
+	if (!result->done) {
+		/* the worker died without reaching the end of the test */
+		if (last != '\n') {
+			printf("\n");
+		}
+		printf("%s: worker exited abnormally\n", worker->testname);
+	}
+	fflush(stdout);
+
+	worker->pid = 0;
+	tctest_num_active_workers--;
+	tctest_report(worker->testname, passed, result->seconds);
+}
+
+int tctest_begin_test(const char *testname) {
+	if (tctest_num_workers > 1 && tctest_worker_slot < 0) {
+		if (!tctest_workers) {
+			tctest_workers = calloc(tctest_num_workers, sizeof(tctest_worker));
+			tctest_worker_results = mmap(NULL, tctest_num_workers * sizeof(tctest_worker_result),
+				PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+			if (tctest_worker_results == MAP_FAILED) {
+				tctest_worker_results = NULL;
+			}
+		}
+
+		if (tctest_workers && tctest_worker_results) {
+			while (tctest_num_active_workers >= tctest_num_workers) {
+				tctest_reap_worker();
+			}
+
+			int slot = 0;
+			while (tctest_workers[slot].pid != 0) {
+				slot++;
+			}
+
+			/* clear the slot before forking, so a worker that dies before
+			   writing its result is never mistaken for the slot's last one */
+			memset(&tctest_worker_results[slot], 0, sizeof(tctest_worker_result));
+
+			FILE *output = tmpfile();
+			fflush(stdout);
+			pid_t pid = output ? fork() : -1;
+			if (pid == 0) {
+				/* worker: run the test with stdout going to the buffer */
+				tctest_worker_slot = slot;
+				dup2(fileno(output), 1);
+				tctest_test_start = tctest_now();
+				return 1;
+			} else if (pid > 0) {
+				tctest_workers[slot].pid = pid;
+				tctest_workers[slot].testname = testname;
+				tctest_workers[slot].output = output;
+				tctest_num_active_workers++;
+				return 0;
+			}
+			/* couldn't start a worker, so run the test here */
+			if (output) {
+				fclose(output);
+			}
+		}
+	}
+
+	tctest_test_start = tctest_now();
+	return 1;
+}
+
+void tctest_end_test(const char *testname, int passed) {
+	double seconds = tctest_now() - tctest_test_start;
+	if (tctest_worker_slot >= 0) {
+		tctest_worker_results[tctest_worker_slot].passed = passed;
+		tctest_worker_results[tctest_worker_slot].seconds = seconds;
+		tctest_worker_results[tctest_worker_slot].done = 1;
+	} else {
+		tctest_report(testname, passed, seconds);
+	}
+}
+
+void tctest_exit_worker(void) {
+	if (tctest_worker_slot >= 0) {
+		fflush(stdout);
+		_exit(tctest_worker_results[tctest_worker_slot].passed ? 0 : 1);
+	}
+}
+
+void tctest_wait_workers(void) {
+	while (tctest_num_active_workers > 0) {
+		tctest_reap_worker();
+	}
+}
@@ -65,32 +65,58 @@ extern void (*tctest_on_test_executed)(const char *testname, int passed);
  */
 extern void (*tctest_on_complete)(int num_passed, int num_executed);
 
+/*
+ * Wall-clock time (in seconds) taken by the most recently executed
+ * test. This is valid while tctest_on_test_executed is being called,
+ * so the callback can report per-test timing.
+ */
+extern double tctest_last_test_seconds;
+
+/*
+ * Setting this to a value greater than 1 (before the first TEST)
+ * runs tests in parallel: each test executes in its own forked
+ * worker process, with up to this many workers at a time. A crash
+ * in a test only takes down its worker. Each test's output is
+ * printed as a unit when it completes, so tests may be reported
+ * out of order. tctest_on_test_executed is still called in the
+ * parent process, once per test.
+ */
+extern int tctest_num_workers;
+
+/*
+ * Functions used by the TEST and TEST_FINI macros.
+ * tctest_begin_test returns true if the calling process should
+ * execute the test body (false if it was handed to a worker).
+ */
+int tctest_begin_test(const char *testname);
+void tctest_end_test(const char *testname, int passed);
+void tctest_exit_worker(void);
+void tctest_wait_workers(void);
+
 #define TEST_INIT() do { \
 	tctest_register_signal_handlers(); \
 } while (0)
 
 #define TEST(func) do { \
 	if (!tctest_testname_to_execute || strcmp(tctest_testname_to_execute, #func) == 0) { \
-		TestObjs *t = 0; \
 		tctest_num_executed++; \
-		tctest_assertion_line = -1; \
-		if (sigsetjmp(tctest_env, 1) == 0) { \
-			t = setup(); \
-			printf("%s...", #func); \
-			fflush(stdout); \
-			func(t); \
-			printf("passed!\n"); \
-			if (tctest_on_test_executed) { \
-				tctest_on_test_executed(#func, 1); \
+		if (tctest_begin_test(#func)) { \
+			TestObjs * volatile t = 0; \
+			tctest_assertion_line = -1; \
+			if (sigsetjmp(tctest_env, 1) == 0) { \
+				t = setup(); \
+				printf("%s...", #func); \
+				fflush(stdout); \
+				func(t); \
+				printf("passed!\n"); \
+				tctest_end_test(#func, 1); \
+			} else { \
+				tctest_end_test(#func, 0); \
 			} \
-		} else { \
-			tctest_failures++; \
-			if (tctest_on_test_executed) { \
-				tctest_on_test_executed(#func, 0); \
+			if (t) { \
+				cleanup(t); \
 			} \
-		} \
-		if (t) { \
-			cleanup(t); \
+			tctest_exit_worker(); \
 		} \
 	} \
 } while (0)
@@ -114,6 +140,7 @@ extern void (*tctest_on_complete)(int num_passed, int num_executed);
 } while (0)
 
 #define TEST_FINI() do { \
+	tctest_wait_workers(); \
 	if (tctest_failures == 0) { \
 		printf("All tests passed!\n"); \
 	} else { \
@@ -2,7 +2,29 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <pthread.h>
+#include <unistd.h>
 #include "uint256.h"
+#include "uint256_stats.h"
+#include "uint256_testing.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define UINT256_BITS_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+// Number of 64-bit columns used to accumulate a 512-bit product
+#define UINT256_COLUMNS 16
+
+// Each product adds less than 2^36 to a column, so flushing carries
+// every 2^26 products keeps every column below 2^63
+#define UINT256_DOT_FLUSH_INTERVAL (1UL << 26)
+
+// Arrays shorter than this are not worth splitting across threads
+#define UINT256_DOT_PARALLEL_MIN 65536
+#define UINT256_SCAN_PARALLEL_MIN 262144
+#define UINT256_MAX_THREADS 16
 
 // Create a UInt256 value from a single uint32_t value.
 // Only the least-significant 32 bits are initialized directly,
@@ -31,6 +53,7 @@ UInt256 uint256_create(const uint32_t data[8]) {
 
 // Create a UInt256 value from a string of hexadecimal digits.
 UInt256 uint256_create_from_hex(const char *hex) {
+  UINT256_STATS_BEGIN(UINT256_OP_CREATE_FROM_HEX);
   UInt256 result;
   // start at end of the string (not including null terminator) - so read right to left
   const char * currentHex = hex;
@@ -39,6 +62,7 @@ UInt256 uint256_create_from_hex(const char *hex) {
   }
   // scan 64 characters max (or until reaches start of string)
   char *buffer = malloc(sizeof(char) * 9);
+  UINT256_STATS_ALLOC(UINT256_OP_CREATE_FROM_HEX, sizeof(char) * 9);
   for (int i = 0; i < 8; i++) {
     strcpy(buffer, "00000000"); // clean buffer
     for (int j = 0; j < 8 && currentHex != hex-1; j++, currentHex--) {
@@ -48,33 +72,31 @@ UInt256 uint256_create_from_hex(const char *hex) {
     result.data[i] = strtoul(buffer, NULL, 16);
   }
   free(buffer);
+  UINT256_STATS_END(UINT256_OP_CREATE_FROM_HEX);
   return result;
 }
 
 // Return a dynamically-allocated string of hex digits representing the
 // given UInt256 value.
 char *uint256_format_as_hex(UInt256 val) {
-  char *hex = calloc(65, sizeof(char)); // 64 hex digits max + null terminator (all initialized to null terminators)
-
-  // copy bits to hex in chunks of 8 bytes
-  char *buffer = malloc(sizeof(char) * 9);
-  for (int i = 7; i >= 0; i--){
-    uint32_t value = val.data[i];
-    sprintf(buffer, "%08x", value);
-    strcat(hex + ((7 - i) * 8), buffer);
+  UINT256_STATS_BEGIN(UINT256_OP_FORMAT_AS_HEX);
+  // number of hex digits without leading zeros (at least one, for 0)
+  unsigned numDigits = (uint256_bit_length(val) + 3) / 4;
+  if (numDigits == 0) {
+    numDigits = 1;
   }
-  free(buffer);
 
-  // trim leading zeros
-  char *leadingHex = hex;
-  while (*leadingHex == '0' && *(leadingHex + 1) != '\0') {
-    leadingHex++;
+  char *hex = malloc(numDigits + 1);
+  UINT256_STATS_ALLOC(UINT256_OP_FORMAT_AS_HEX, numDigits + 1);
+  // write digits right to left, 4 bits at a time
+  for (unsigned i = 0; i < numDigits; i++) {
+    uint32_t nibble = (val.data[i / 8] >> ((i % 8) * 4)) & 0xf;
+    hex[numDigits - 1 - i] = "0123456789abcdef"[nibble];
   }
-  char *trimmedHex = malloc(65 - (leadingHex - hex)); // alloc amount of space for bits after leadingHex
-  strcpy(trimmedHex, leadingHex); // copy bits after leadingHex
-  free(hex);
+  hex[numDigits] = '\0';
 
-  return trimmedHex;
+  UINT256_STATS_END(UINT256_OP_FORMAT_AS_HEX);
+  return hex;
 }
 
 // Get 32 bits of data from a UInt256 value.
@@ -86,6 +108,172 @@ uint32_t uint256_get_bits(UInt256 val, unsigned index) {
   return bits;
 }
 
+// Bit-counting instructions available on this CPU, detected once.
+// The default build targets plain x86-64, which has none of them, so
+// clz, ctz and popcount pick LZCNT/TZCNT/POPCNT kernels at run time,
+// and popcount_n uses AVX-512 VPOPCNTQ where the CPU has it.
+#ifdef UINT256_BITS_X86
+static int hasPopcnt;
+static int hasLzcnt;
+static int hasBmi;
+static int hasVpopcntq;
+#endif
+static pthread_once_t uint256_bits_once = PTHREAD_ONCE_INIT;
+
+static void uint256_detect_bit_kernels(void) {
+#ifdef UINT256_BITS_X86
+  unsigned eax, ebx, ecx, edx;
+  __builtin_cpu_init();
+  hasPopcnt = __builtin_cpu_supports("popcnt");
+  hasBmi = __builtin_cpu_supports("bmi");
+  // LZCNT is reported in the extended leaf (ABM), not in the cpu model
+  hasLzcnt = __get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx) && (ecx & (1U << 5));
+  hasVpopcntq = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq");
+#endif
+}
+
+#ifdef UINT256_BITS_X86
+__attribute__((target("lzcnt")))
+static unsigned uint256_clz_lzcnt(UInt256 val) {
+  for (int i = 7; i >= 0; i--) {
+    if (val.data[i] != 0) {
+      return (7 - i) * 32 + __builtin_clz(val.data[i]);
+    }
+  }
+  return 256;
+}
+
+__attribute__((target("bmi")))
+static unsigned uint256_ctz_tzcnt(UInt256 val) {
+  for (int i = 0; i <= 7; i++) {
+    if (val.data[i] != 0) {
+      return i * 32 + __builtin_ctz(val.data[i]);
+    }
+  }
+  return 256;
+}
+
+__attribute__((target("popcnt")))
+static unsigned uint256_popcount_popcnt(const UInt256 *val) {
+  uint64_t words[4];
+  memcpy(words, val->data, sizeof(words));
+  return __builtin_popcountll(words[0]) + __builtin_popcountll(words[1]) +
+    __builtin_popcountll(words[2]) + __builtin_popcountll(words[3]);
+}
+
+// Popcount two values per 512-bit register: VPOPCNTQ counts each
+// 64-bit limb, and each 256-bit half is summed into one count.
+__attribute__((target("avx512f,avx512vpopcntdq")))
+static size_t uint256_popcount_n_vpopcntq(const UInt256 *vals, size_t n, unsigned *counts) {
+  size_t j = 0;
+  for (; j + 2 <= n; j += 2) {
+    __m512i limbs = _mm512_popcnt_epi64(_mm512_loadu_si512((const void *) (vals + j)));
+    counts[j] = (unsigned) _mm512_mask_reduce_add_epi64(0x0F, limbs);
+    counts[j + 1] = (unsigned) _mm512_mask_reduce_add_epi64(0xF0, limbs);
+  }
+  return j;
+}
+#endif
+
+// Return the number of leading (most significant) zero bits in val.
+// Returns 256 if val is 0.
+unsigned uint256_clz(UInt256 val) {
+  pthread_once(&uint256_bits_once, uint256_detect_bit_kernels);
+#ifdef UINT256_BITS_X86
+  if (hasLzcnt) {
+    return uint256_clz_lzcnt(val);
+  }
+#endif
+  for (int i = 7; i >= 0; i--) {
+    if (val.data[i] != 0) {
+      return (7 - i) * 32 + __builtin_clz(val.data[i]);
+    }
+  }
+  return 256;
+}
+
+// Return the number of trailing (least significant) zero bits in val.
+// Returns 256 if val is 0.
+unsigned uint256_ctz(UInt256 val) {
+  pthread_once(&uint256_bits_once, uint256_detect_bit_kernels);
+#ifdef UINT256_BITS_X86
+  if (hasBmi) {
+    return uint256_ctz_tzcnt(val);
+  }
+#endif
+  for (int i = 0; i <= 7; i++) {
+    if (val.data[i] != 0) {
+      return i * 32 + __builtin_ctz(val.data[i]);
+    }
+  }
+  return 256;
+}
+
+// Return the number of bits set to 1 in val.
+unsigned uint256_popcount(UInt256 val) {
+  pthread_once(&uint256_bits_once, uint256_detect_bit_kernels);
+#ifdef UINT256_BITS_X86
+  if (hasPopcnt) {
+    return uint256_popcount_popcnt(&val);
+  }
+#endif
+  unsigned count = 0;
+  for (int i = 0; i <= 7; i++) {
+    count += __builtin_popcount(val.data[i]);
+  }
+  return count;
+}
+
+// Store the popcount of each of the n values in vals into counts.
+// Uses AVX-512 VPOPCNTQ or POPCNT where the CPU has them.
+void uint256_popcount_n(const UInt256 *vals, size_t n, unsigned *counts) {
+  pthread_once(&uint256_bits_once, uint256_detect_bit_kernels);
+  size_t j = 0;
+#ifdef UINT256_BITS_X86
+  if (hasVpopcntq) {
+    j = uint256_popcount_n_vpopcntq(vals, n, counts);
+  } else if (hasPopcnt) {
+    for (; j < n; j++) {
+      counts[j] = uint256_popcount_popcnt(vals + j);
+    }
+  }
+#endif
+  for (; j < n; j++) {
+    unsigned count = 0;
+    for (int i = 0; i <= 7; i++) {
+      count += __builtin_popcount(vals[j].data[i]);
+    }
+    counts[j] = count;
+  }
+}
+
+// Return the number of bits needed to represent val (i.e., the
+// index of the most significant set bit plus one). Returns 0 if
+// val is 0.
+unsigned uint256_bit_length(UInt256 val) {
+  return 256 - uint256_clz(val);
+}
+
+// Return 1 if the bit at the given index (0 is the least significant
+// bit, 255 the most significant) is set, 0 otherwise.
+int uint256_test_bit(UInt256 val, unsigned index) {
+  assert(index < 256);
+  return (val.data[index / 32] >> (index % 32)) & 1U;
+}
+
+// Return a copy of val with the bit at the given index set to 1
+// (if bit is nonzero) or cleared to 0 (if bit is zero).
+UInt256 uint256_set_bit(UInt256 val, unsigned index, int bit) {
+  assert(index < 256);
+  uint32_t mask = 1U << (index % 32);
+  if (bit) {
+    val.data[index / 32] |= mask;
+  } else {
+    val.data[index / 32] &= ~mask;
+  }
+  return val;
+}
+
 // Compute the sum of two UInt256 values.
 UInt256 uint256_add(UInt256 left, UInt256 right) {
   UInt256 sum;
@@ -122,6 +310,1159 @@ UInt256 uint256_negate(UInt256 val) {
   return result;
 }
 
+// Add the 32x32-bit partial products of left*right into 64-bit
+// columns without propagating carries between columns.
+static void uint256_mul_columns(const UInt256 *left, const UInt256 *right, uint64_t acc[UINT256_COLUMNS]) {
+  for (int i = 0; i < 8; i++) {
+    if (left->data[i] == 0) {
+      continue;
+    }
+    for (int j = 0; j < 8; j++) {
+      uint64_t product = (uint64_t) left->data[i] * right->data[j];
+      acc[i + j] += (uint32_t) product;  //bottom 32 bits
+      acc[i + j + 1] += product >> 32;   //top 32 bits
+    }
+  }
+}
+
+// Propagate carries through the columns so that every column holds
+// a 32-bit value. Any carry out of the top column is discarded.
+static void uint256_normalize_columns(uint64_t acc[UINT256_COLUMNS]) {
+  uint64_t carry = 0U;
+  for (int k = 0; k < UINT256_COLUMNS; k++) {
+    uint64_t temp = acc[k] + carry;
+    acc[k] = (uint32_t) temp;
+    carry = temp >> 32;
+  }
+}
+
+// Split normalized columns into low and high 256-bit halves.
+static UInt256 uint256_from_columns(const uint64_t acc[UINT256_COLUMNS], UInt256 *hi) {
+  UInt256 lo;
+  for (int i = 0; i < 8; i++) {
+    lo.data[i] = (uint32_t) acc[i];
+    if (hi) {
+      hi->data[i] = (uint32_t) acc[i + 8];
+    }
+  }
+  return lo;
+}
+
+// Compute the product of two UInt256 values. Only the least
+// significant 256 bits of the product are returned.
+UInt256 uint256_mul(UInt256 left, UInt256 right) {
+  UINT256_STATS_BEGIN(UINT256_OP_MUL);
+  uint64_t acc[UINT256_COLUMNS] = { 0U };
+  uint256_mul_columns(&left, &right, acc);
+  uint256_normalize_columns(acc);
+  UInt256 result = uint256_from_columns(acc, NULL);
+  UINT256_STATS_END(UINT256_OP_MUL);
+  return result;
+}
+
+// Compute a*b+c as a full 512-bit result. The least significant
+// 256 bits are returned, and the most significant 256 bits are
+// stored in *carry (if carry is not NULL).
+UInt256 uint256_muladd(UInt256 a, UInt256 b, UInt256 c, UInt256 *carry) {
+  UINT256_STATS_BEGIN(UINT256_OP_MULADD);
+  uint64_t acc[UINT256_COLUMNS] = { 0U };
+  for (int i = 0; i < 8; i++) {
+    acc[i] = c.data[i];
+  }
+  uint256_mul_columns(&a, &b, acc);
+  uint256_normalize_columns(acc);
+  UInt256 result = uint256_from_columns(acc, carry);
+  UINT256_STATS_END(UINT256_OP_MULADD);
+  return result;
+}
+
+// Accumulate a[i]*b[i] for n elements into the (normalized) columns,
+// only propagating carries once every UINT256_DOT_FLUSH_INTERVAL products.
+static void uint256_dot_columns(const UInt256 *a, const UInt256 *b, size_t n, uint64_t acc[UINT256_COLUMNS]) {
+  size_t sinceFlush = 0;
+  for (size_t i = 0; i < n; i++) {
+    uint256_mul_columns(&a[i], &b[i], acc);
+    if (++sinceFlush == UINT256_DOT_FLUSH_INTERVAL) {
+      uint256_normalize_columns(acc);
+      sinceFlush = 0;
+    }
+  }
+  uint256_normalize_columns(acc);
+}
+
+// Thread count set with uint256_set_num_threads (0 for the default).
+static unsigned uint256_thread_override;
+
+// Set the number of threads that large dot products, sums, prefix sums
+// and min/max scans are split across (at most 16). 0 restores the
+// default of one thread per processor.
+void uint256_set_num_threads(unsigned numThreads) {
+  __atomic_store_n(&uint256_thread_override, numThreads, __ATOMIC_RELAXED);
+}
+
+// Return the number of threads to split an array of n values across:
+// one per processor or as set by uint256_set_num_threads (up to
+// UINT256_MAX_THREADS), or 1 if n is below parallelMin.
+static long uint256_num_threads(size_t n, size_t parallelMin) {
+  long numThreads = 1;
+  if (n >= parallelMin) {
+    numThreads = __atomic_load_n(&uint256_thread_override, __ATOMIC_RELAXED);
+    if (numThreads == 0) {
+      numThreads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (numThreads > UINT256_MAX_THREADS) {
+      numThreads = UINT256_MAX_THREADS;
+    }
+  }
+  return numThreads < 1 ? 1 : numThreads;
+}
+
+// Run worker on each of numThreads chunks (an array of chunkSize-byte
+// structs), one thread per chunk, and wait for all of them.
+static void uint256_run_chunks(void *(*worker)(void *), void *chunks, size_t chunkSize, long numThreads) {
+  pthread_t threads[UINT256_MAX_THREADS];
+  int started[UINT256_MAX_THREADS];
+  for (long t = 0; t < numThreads; t++) {
+    void *chunk = (char *) chunks + t * chunkSize;
+    started[t] = pthread_create(&threads[t], NULL, worker, chunk) == 0;
+    if (!started[t]) {
+      worker(chunk);  //fall back to running it on this thread
+    }
+  }
+  for (long t = 0; t < numThreads; t++) {
+    if (started[t]) {
+      pthread_join(threads[t], NULL);
+    }
+  }
+}
+
+typedef struct {
+  const UInt256 *a;
+  const UInt256 *b;
+  size_t n;
+  uint64_t acc[UINT256_COLUMNS];
+} DotChunk;
+
+static void *uint256_dot_worker(void *arg) {
+  DotChunk *chunk = arg;
+  uint256_dot_columns(chunk->a, chunk->b, chunk->n, chunk->acc);
+  return NULL;
+}
+
+// Compute the dot product sum(a[i]*b[i]) of two arrays of n values.
+// The sum is accumulated in 512 bits; the least significant 256 bits
+// are returned and the next 256 bits are stored in *hi (if hi is not
+// NULL). Large arrays are split across multiple threads.
+UInt256 uint256_dot_n_wide(const UInt256 *a, const UInt256 *b, size_t n, UInt256 *hi) {
+  UINT256_STATS_BEGIN(UINT256_OP_DOT_N);
+  uint64_t acc[UINT256_COLUMNS] = { 0U };
+
+  long numThreads = uint256_num_threads(n, UINT256_DOT_PARALLEL_MIN);
+  if (numThreads == 1) {
+    uint256_dot_columns(a, b, n, acc);
+    UINT256_STATS_END(UINT256_OP_DOT_N);
+    return uint256_from_columns(acc, hi);
+  }
+
+  // each thread sums its own slice, then the normalized partial sums are added
+  DotChunk chunks[UINT256_MAX_THREADS];
+  size_t perThread = n / numThreads;
+  for (long t = 0; t < numThreads; t++) {
+    size_t begin = t * perThread;
+    chunks[t].a = a + begin;
+    chunks[t].b = b + begin;
+    chunks[t].n = (t == numThreads - 1) ? n - begin : perThread;
+    memset(chunks[t].acc, 0, sizeof(chunks[t].acc));
+  }
+  uint256_run_chunks(uint256_dot_worker, chunks, sizeof(DotChunk), numThreads);
+  for (long t = 0; t < numThreads; t++) {
+    for (int k = 0; k < UINT256_COLUMNS; k++) {
+      acc[k] += chunks[t].acc[k];
+    }
+  }
+  uint256_normalize_columns(acc);
+  UINT256_STATS_END(UINT256_OP_DOT_N);
+  return uint256_from_columns(acc, hi);
+}
+
+// Compute the dot product sum(a[i]*b[i]) of two arrays of n values,
+// wrapping modulo 2^256 like uint256_add.
+UInt256 uint256_dot_n(const UInt256 *a, const UInt256 *b, size_t n) {
+  return uint256_dot_n_wide(a, b, n, NULL);
+}
+
+// Propagate carries between the accumulator's limbs so that every
+// slot holds a 32-bit value again.
+static void uint256_accumulator_normalize(UInt256Accumulator *acc) {
+  uint64_t carry = 0U;
+  for (int i = 0; i < 8; i++) {
+    uint64_t temp = acc->limbs[i] + carry;
+    acc->limbs[i] = (uint32_t) temp;
+    carry = temp >> 32;
+  }
+  acc->count = 0;
+}
+
+// Reset an accumulator to hold the value 0.
+void uint256_accumulator_init(UInt256Accumulator *acc) {
+  for (int i = 0; i < 8; i++) {
+    acc->limbs[i] = 0U;
+  }
+  acc->count = 0;
+}
+
+// Add a UInt256 value to an accumulator.
+void uint256_accumulator_add(UInt256Accumulator *acc, UInt256 val) {
+  if (acc->count == UINT32_MAX) {
+    uint256_accumulator_normalize(acc);
+  }
+  for (int i = 0; i < 8; i++) {
+    acc->limbs[i] += val.data[i];  //no carry between limbs
+  }
+  acc->count++;
+}
+
+// Add an array of n UInt256 values to an accumulator.
+void uint256_accumulator_add_n(UInt256Accumulator *acc, const UInt256 *vals, size_t n) {
+  UINT256_STATS_BEGIN(UINT256_OP_ACCUMULATOR_ADD_N);
+  while (n > 0) {
+    if (acc->count == UINT32_MAX) {
+      uint256_accumulator_normalize(acc);
+    }
+    // largest run that can be added before a slot could overflow
+    size_t run = UINT32_MAX - acc->count;
+    if (run > n) {
+      run = n;
+    }
+
+    // the limbs are independent, so this loop vectorizes
+    uint64_t limbs[8];
+    memcpy(limbs, acc->limbs, sizeof(limbs));
+    for (size_t j = 0; j < run; j++) {
+      for (int i = 0; i < 8; i++) {
+        limbs[i] += vals[j].data[i];
+      }
+    }
+    memcpy(acc->limbs, limbs, sizeof(limbs));
+
+    acc->count += (uint32_t) run;
+    vals += run;
+    n -= run;
+  }
+  UINT256_STATS_END(UINT256_OP_ACCUMULATOR_ADD_N);
+}
+
+// Return the accumulated sum, wrapping modulo 2^256 like uint256_add.
+UInt256 uint256_accumulator_value(UInt256Accumulator *acc) {
+  UInt256 result;
+  uint256_accumulator_normalize(acc);
+  for (int i = 0; i < 8; i++) {
+    result.data[i] = (uint32_t) acc->limbs[i];
+  }
+  return result;
+}
+
+// One thread's slice of a sum, scan or min/max reduction.
+typedef struct {
+  const UInt256 *in;
+  UInt256 *out;
+  size_t n;
+  UInt256 offset;   // prefix sum: the sum of everything before this slice
+  UInt256 result;   // the slice's sum, minimum or maximum
+  int findMax;      // min/max: 1 to find the maximum, 0 for the minimum
+} ScanChunk;
+
+// Split n values into numThreads slices.
+static void uint256_split_scan(ScanChunk *chunks, long numThreads, const UInt256 *in, UInt256 *out, size_t n) {
+  size_t perThread = n / numThreads;
+  for (long t = 0; t < numThreads; t++) {
+    size_t begin = t * perThread;
+    chunks[t].in = in + begin;
+    chunks[t].out = out ? out + begin : NULL;
+    chunks[t].n = (t == numThreads - 1) ? n - begin : perThread;
+    chunks[t].offset = uint256_create_from_u32(0U);
+  }
+}
+
+static void *uint256_sum_worker(void *arg) {
+  ScanChunk *chunk = arg;
+  UInt256Accumulator acc;
+  uint256_accumulator_init(&acc);
+  uint256_accumulator_add_n(&acc, chunk->in, chunk->n);
+  chunk->result = uint256_accumulator_value(&acc);
+  return NULL;
+}
+
+// Compute the inclusive prefix sums of a slice, starting from its
+// offset. The running sum is kept without carries between limbs (as
+// in UInt256Accumulator), so consecutive elements don't wait on each
+// other's carry chains; each output normalizes its own copy.
+static void *uint256_prefix_sum_worker(void *arg) {
+  ScanChunk *chunk = arg;
+  uint64_t limbs[8];
+  for (int i = 0; i < 8; i++) {
+    limbs[i] = chunk->offset.data[i];
+  }
+  uint32_t count = 0;
+  for (size_t j = 0; j < chunk->n; j++) {
+    for (int i = 0; i < 8; i++) {
+      limbs[i] += chunk->in[j].data[i];  //no carry between limbs
+    }
+    uint64_t carry = 0U;
+    for (int i = 0; i < 8; i++) {
+      uint64_t temp = limbs[i] + carry;
+      chunk->out[j].data[i] = (uint32_t) temp;
+      carry = temp >> 32;
+    }
+    if (++count == UINT32_MAX) {
+      // fold the carries back in before a limb could overflow
+      for (int i = 0; i < 8; i++) {
+        limbs[i] = chunk->out[j].data[i];
+      }
+      count = 0;
+    }
+  }
+  return NULL;
+}
+
+static void *uint256_min_max_worker(void *arg) {
+  ScanChunk *chunk = arg;
+  UInt256 best = chunk->in[0];
+  int want = chunk->findMax ? 1 : -1;
+  for (size_t j = 1; j < chunk->n; j++) {
+    if (uint256_compare(chunk->in[j], best) == want) {
+      best = chunk->in[j];
+    }
+  }
+  chunk->result = best;
+  return NULL;
+}
+
+// Compute the sum of n values, wrapping modulo 2^256 like uint256_add.
+// Large arrays are split across multiple threads.
+UInt256 uint256_sum(const UInt256 *vals, size_t n) {
+  ScanChunk chunks[UINT256_MAX_THREADS];
+  long numThreads = uint256_num_threads(n, UINT256_SCAN_PARALLEL_MIN);
+  uint256_split_scan(chunks, numThreads, vals, NULL, n);
+  if (numThreads == 1) {
+    uint256_sum_worker(&chunks[0]);
+  } else {
+    uint256_run_chunks(uint256_sum_worker, chunks, sizeof(ScanChunk), numThreads);
+  }
+  UInt256 sum = uint256_create_from_u32(0U);
+  for (long t = 0; t < numThreads; t++) {
+    sum = uint256_add(sum, chunks[t].result);
+  }
+  return sum;
+}
+
+// Store the inclusive prefix sums of n values in out, so that out[i]
+// is vals[0] + ... + vals[i] (wrapping modulo 2^256). out may be the
+// same array as vals. Large arrays are scanned by multiple threads in
+// two passes: each thread sums its slice, then each rescans its slice
+// starting from the total of the slices before it. Addition modulo
+// 2^256 is exact, so the result doesn't depend on the number of threads.
+void uint256_prefix_sum(const UInt256 *vals, UInt256 *out, size_t n) {
+  ScanChunk chunks[UINT256_MAX_THREADS];
+  long numThreads = uint256_num_threads(n, UINT256_SCAN_PARALLEL_MIN);
+  uint256_split_scan(chunks, numThreads, vals, out, n);
+  if (numThreads == 1) {
+    uint256_prefix_sum_worker(&chunks[0]);
+    return;
+  }
+
+  uint256_run_chunks(uint256_sum_worker, chunks, sizeof(ScanChunk), numThreads);
+  for (long t = 1; t < numThreads; t++) {
+    chunks[t].offset = uint256_add(chunks[t - 1].offset, chunks[t - 1].result);
+  }
+  uint256_run_chunks(uint256_prefix_sum_worker, chunks, sizeof(ScanChunk), numThreads);
+}
+
+// Find the minimum or maximum of n values (n > 0).
+static UInt256 uint256_min_max(const UInt256 *vals, size_t n, int findMax) {
+  ScanChunk chunks[UINT256_MAX_THREADS];
+  long numThreads = uint256_num_threads(n, UINT256_SCAN_PARALLEL_MIN);
+  uint256_split_scan(chunks, numThreads, vals, NULL, n);
+  for (long t = 0; t < numThreads; t++) {
+    chunks[t].findMax = findMax;
+  }
+  if (numThreads == 1) {
+    uint256_min_max_worker(&chunks[0]);
+  } else {
+    uint256_run_chunks(uint256_min_max_worker, chunks, sizeof(ScanChunk), numThreads);
+  }
+  UInt256 best = chunks[0].result;
+  for (long t = 1; t < numThreads; t++) {
+    if (uint256_compare(chunks[t].result, best) == (findMax ? 1 : -1)) {
+      best = chunks[t].result;
+    }
+  }
+  return best;
+}
+
+// Return the smallest of n values, or 2^256-1 if n is 0.
+UInt256 uint256_min(const UInt256 *vals, size_t n) {
+  if (n == 0) {
+    return uint256_negate(uint256_create_from_u32(1U));
+  }
+  return uint256_min_max(vals, n, 0);
+}
+
+// Return the largest of n values, or 0 if n is 0.
+UInt256 uint256_max(const UInt256 *vals, size_t n) {
+  if (n == 0) {
+    return uint256_create_from_u32(0U);
+  }
+  return uint256_min_max(vals, n, 1);
+}
+
+// Return 1 if val is 0, 0 otherwise.
+int uint256_is_zero(UInt256 val) {
+  uint32_t bits = 0U;
+  for (int i = 0; i <= 7; i++) {
+    bits |= val.data[i];
+  }
+  return bits == 0U;
+}
+
+// Compare two UInt256 values. Returns a negative value if left < right,
+// 0 if left == right, and a positive value if left > right.
+int uint256_compare(UInt256 left, UInt256 right) {
+  for (int i = 7; i >= 0; i--) {
+    if (left.data[i] != right.data[i]) {
+      return left.data[i] < right.data[i] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+// Return the result of shifting val nbits to the left. Bits shifted
+// past the most significant bit are discarded. nbits >= 256 gives 0.
+UInt256 uint256_shift_left(UInt256 val, unsigned nbits) {
+  UInt256 result = uint256_create_from_u32(0U);
+  if (nbits >= 256) {
+    return result;
+  }
+  int u32Shift = nbits / 32;
+  int bitShift = nbits % 32;
+
+  for (int u32 = 7; u32 >= u32Shift; u32--) {
+    result.data[u32] = val.data[u32 - u32Shift] << bitShift;
+    // bitShift of 0 would shift by 32, which is undefined
+    if (bitShift != 0 && u32 - u32Shift - 1 >= 0) {
+      result.data[u32] |= val.data[u32 - u32Shift - 1] >> (32 - bitShift);
+    }
+  }
+  return result;
+}
+
+// Return the result of shifting val nbits to the right. Bits shifted
+// past the least significant bit are discarded. nbits >= 256 gives 0.
+UInt256 uint256_shift_right(UInt256 val, unsigned nbits) {
+  UInt256 result = uint256_create_from_u32(0U);
+  if (nbits >= 256) {
+    return result;
+  }
+  int u32Shift = nbits / 32;
+  int bitShift = nbits % 32;
+
+  for (int u32 = 0; u32 + u32Shift <= 7; u32++) {
+    result.data[u32] = val.data[u32 + u32Shift] >> bitShift;
+    if (bitShift != 0 && u32 + u32Shift + 1 <= 7) {
+      result.data[u32] |= val.data[u32 + u32Shift + 1] << (32 - bitShift);
+    }
+  }
+  return result;
+}
+
+// Return the number of significant limbs in an array of limbs.
+static int uint256_trim_limbs(const uint32_t *limbs, int len) {
+  while (len > 0 && limbs[len - 1] == 0) {
+    len--;
+  }
+  return len;
+}
+
+// Divide the m-limb value u (m <= 16) by the n-limb value v (n >= 2,
+// m >= n) using Knuth's Algorithm D. The m-n+1 quotient limbs are
+// stored in q, and the remainder is returned.
+static UInt256 uint256_knuth_divide(const uint32_t *u, int m, UInt256 v, int n, uint32_t *q) {
+  // normalize so the divisor's top limb has its most significant bit
+  // set, which makes each estimated quotient limb off by at most 2
+  int s = __builtin_clz(v.data[n - 1]);
+  UInt256 vn = uint256_shift_left(v, s);
+  uint32_t un[17];
+  un[m] = s == 0 ? 0U : u[m - 1] >> (32 - s);
+  for (int i = m - 1; i > 0; i--) {
+    un[i] = (u[i] << s) | (s == 0 ? 0U : u[i - 1] >> (32 - s));
+  }
+  un[0] = u[0] << s;
+
+  for (int j = m - n; j >= 0; j--) {
+    uint64_t num = ((uint64_t) un[j + n] << 32) | un[j + n - 1];
+    uint64_t qhat = num / vn.data[n - 1];
+    uint64_t rhat = num % vn.data[n - 1];
+    while (qhat > UINT32_MAX ||
+           qhat * vn.data[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+      qhat--;
+      rhat += vn.data[n - 1];
+      if (rhat > UINT32_MAX) {
+        break;
+      }
+    }
+
+    // multiply and subtract qhat * vn from un[j..j+n]
+    int64_t borrow = 0;
+    int64_t temp;
+    for (int i = 0; i < n; i++) {
+      uint64_t product = qhat * vn.data[i];
+      temp = un[i + j] - borrow - (int64_t) (product & 0xffffffffU);
+      un[i + j] = (uint32_t) temp;
+      borrow = (int64_t) (product >> 32) - (temp >> 32);
+    }
+    temp = un[j + n] - borrow;
+    un[j + n] = (uint32_t) temp;
+
+    q[j] = (uint32_t) qhat;
+    if (temp < 0) {
+      // qhat was one too large, add the divisor back
+      q[j]--;
+      uint64_t carry = 0U;
+      for (int i = 0; i < n; i++) {
+        uint64_t sum = (uint64_t) un[i + j] + vn.data[i] + carry;
+        un[i + j] = (uint32_t) sum;
+        carry = sum >> 32;
+      }
+      un[j + n] += (uint32_t) carry;
+    }
+  }
+
+  UInt256 rem = uint256_create_from_u32(0U);
+  for (int i = 0; i < n; i++) {
+    rem.data[i] = un[i];
+  }
+  return uint256_shift_right(rem, s);  //undo normalization
+}
+
+// Compute the quotient of left / right, storing the remainder in
+// *remainder (if remainder is not NULL). right must not be 0.
+UInt256 uint256_divmod(UInt256 left, UInt256 right, UInt256 *remainder) {
+  UINT256_STATS_BEGIN(UINT256_OP_DIVMOD);
+  UInt256 quotient = uint256_create_from_u32(0U);
+  int m = uint256_trim_limbs(left.data, 8);
+  int n = uint256_trim_limbs(right.data, 8);
+  assert(n > 0);
+
+  if (uint256_compare(left, right) < 0) {
+    if (remainder) {
+      *remainder = left;
+    }
+    UINT256_STATS_END(UINT256_OP_DIVMOD);
+    return quotient;
+  }
+
+  if (n == 1) {
+    // short division by a single limb
+    uint64_t rem = 0U;
+    for (int i = m - 1; i >= 0; i--) {
+      uint64_t num = (rem << 32) | left.data[i];
+      quotient.data[i] = (uint32_t) (num / right.data[0]);
+      rem = num % right.data[0];
+    }
+    if (remainder) {
+      *remainder = uint256_create_from_u32((uint32_t) rem);
+    }
+    UINT256_STATS_END(UINT256_OP_DIVMOD);
+    return quotient;
+  }
+
+  UInt256 rem = uint256_knuth_divide(left.data, m, right, n, quotient.data);
+  if (remainder) {
+    *remainder = rem;
+  }
+  UINT256_STATS_END(UINT256_OP_DIVMOD);
+  return quotient;
+}
+
+// Return the integer square root of val (the largest value r such
+// that r*r <= val).
+UInt256 uint256_isqrt(UInt256 val) {
+  if (uint256_is_zero(val)) {
+    return val;
+  }
+
+  // 2^ceil(bits/2) is always >= sqrt(val), so Newton's method
+  // decreases monotonically from there to the floor of the root
+  unsigned bits = uint256_bit_length(val);
+  UInt256 x = uint256_shift_left(uint256_create_from_u32(1U), (bits + 1) / 2);
+  UInt256 y = uint256_shift_right(uint256_add(x, uint256_divmod(val, x, NULL)), 1);
+  while (uint256_compare(y, x) < 0) {
+    x = y;
+    y = uint256_shift_right(uint256_add(x, uint256_divmod(val, x, NULL)), 1);
+  }
+  return x;
+}
+
+// Return the greatest common divisor of two UInt256 values.
+// gcd(x, 0) is x.
+UInt256 uint256_gcd(UInt256 left, UInt256 right) {
+  if (uint256_is_zero(left)) {
+    return right;
+  }
+  if (uint256_is_zero(right)) {
+    return left;
+  }
+
+  // binary GCD: strip the common power of two, then repeatedly
+  // subtract the smaller odd value from the larger
+  unsigned commonTwos = uint256_ctz(left);
+  unsigned rightTwos = uint256_ctz(right);
+  if (rightTwos < commonTwos) {
+    commonTwos = rightTwos;
+  }
+  left = uint256_shift_right(left, uint256_ctz(left));
+  do {
+    right = uint256_shift_right(right, uint256_ctz(right));
+    if (uint256_compare(left, right) > 0) {
+      UInt256 temp = left;
+      left = right;
+      right = temp;
+    }
+    right = uint256_sub(right, left);
+  } while (!uint256_is_zero(right));
+
+  return uint256_shift_left(left, commonTwos);
+}
+
+// Compute base raised to the power exp, wrapping modulo 2^256.
+UInt256 uint256_pow(UInt256 base, uint64_t exp) {
+  UInt256 result = uint256_create_from_u32(1U);
+  while (exp != 0) {
+    if (exp & 1U) {
+      result = uint256_mul(result, base);
+    }
+    exp >>= 1;
+    if (exp != 0) {
+      base = uint256_mul(base, base);
+    }
+  }
+  return result;
+}
+
+// Compute base raised to the power exp. Returns 1 and stores the
+// result in *result if it fits in 256 bits, otherwise returns 0
+// (and *result is left unchanged).
+int uint256_pow_checked(UInt256 base, uint64_t exp, UInt256 *result) {
+  UInt256 zero = uint256_create_from_u32(0U);
+  UInt256 product = uint256_create_from_u32(1U);
+  UInt256 carry;
+  while (exp != 0) {
+    if (exp & 1U) {
+      product = uint256_muladd(product, base, zero, &carry);
+      if (!uint256_is_zero(carry)) {
+        return 0;
+      }
+    }
+    exp >>= 1;
+    // only square when another bit of exp still needs it, so the last
+    // (unused) square can't report a false overflow
+    if (exp != 0) {
+      base = uint256_muladd(base, base, zero, &carry);
+      if (!uint256_is_zero(carry)) {
+        return 0;
+      }
+    }
+  }
+  *result = product;
+  return 1;
+}
+
+// Return the remainder of the len-limb value u (len <= 16) divided by m.
+static UInt256 uint256_reduce_limbs(const uint32_t *u, int len, UInt256 m) {
+  int ulen = uint256_trim_limbs(u, len);
+  int n = uint256_trim_limbs(m.data, 8);
+  assert(n > 0);
+
+  UInt256 rem = uint256_create_from_u32(0U);
+  if (ulen < n) {
+    // fewer limbs than m, so u is already reduced
+    for (int i = 0; i < ulen; i++) {
+      rem.data[i] = u[i];
+    }
+    return rem;
+  }
+  if (n == 1) {
+    uint64_t r = 0U;
+    for (int i = ulen - 1; i >= 0; i--) {
+      r = ((r << 32) | u[i]) % m.data[0];
+    }
+    rem.data[0] = (uint32_t) r;
+    return rem;
+  }
+  uint32_t q[16];
+  return uint256_knuth_divide(u, ulen, m, n, q);
+}
+
+// Compute (left - right) mod m, for left and right less than m.
+static UInt256 uint256_submod(UInt256 left, UInt256 right, UInt256 m) {
+  UInt256 diff = uint256_sub(left, right);
+  if (uint256_compare(left, right) < 0) {
+    diff = uint256_add(diff, m);
+  }
+  return diff;
+}
+
+// Compute (left * right) mod m. m must not be 0.
+UInt256 uint256_mulmod(UInt256 left, UInt256 right, UInt256 m) {
+  uint64_t acc[UINT256_COLUMNS] = { 0U };
+  uint256_mul_columns(&left, &right, acc);
+  uint256_normalize_columns(acc);
+  uint32_t product[UINT256_COLUMNS];
+  for (int k = 0; k < UINT256_COLUMNS; k++) {
+    product[k] = (uint32_t) acc[k];
+  }
+  return uint256_reduce_limbs(product, UINT256_COLUMNS, m);
+}
+
+// Compute base raised to the power exp, modulo m. m must not be 0.
+UInt256 uint256_mod_pow(UInt256 base, UInt256 exp, UInt256 m) {
+  UInt256 result = uint256_reduce_limbs(uint256_create_from_u32(1U).data, 8, m);
+  base = uint256_reduce_limbs(base.data, 8, m);
+  // left to right over the bits of exp
+  for (int bit = (int) uint256_bit_length(exp) - 1; bit >= 0; bit--) {
+    result = uint256_mulmod(result, result, m);
+    if (uint256_test_bit(exp, bit)) {
+      result = uint256_mulmod(result, base, m);
+    }
+  }
+  return result;
+}
+
+// Compute the inverse of val modulo m (the value x such that
+// val*x mod m == 1). Returns 1 and stores the inverse in *inv if it
+// exists, otherwise returns 0. m must not be 0.
+int uint256_mod_inv(UInt256 val, UInt256 m, UInt256 *inv) {
+  // extended Euclidean algorithm, keeping only the coefficient of val
+  // (reduced mod m so it never goes negative)
+  UInt256 r0 = m;
+  UInt256 r1 = uint256_reduce_limbs(val.data, 8, m);
+  UInt256 t0 = uint256_create_from_u32(0U);
+  UInt256 t1 = uint256_create_from_u32(1U);
+  while (!uint256_is_zero(r1)) {
+    UInt256 rem;
+    UInt256 q = uint256_divmod(r0, r1, &rem);
+    r0 = r1;
+    r1 = rem;
+    UInt256 t = uint256_submod(t0, uint256_mulmod(q, t1, m), m);
+    t0 = t1;
+    t1 = t;
+  }
+  if (uint256_compare(r0, uint256_create_from_u32(1U)) != 0) {
+    return 0;  //val and m share a factor
+  }
+  *inv = t0;
+  return 1;
+}
+
+// Compute the inverses modulo m of the n values in "in", storing them
+// in "out" (which must not overlap "in"). Uses Montgomery's
+// trick: one modular inversion plus 3(n-1) modular multiplications.
+// Returns 1 on success, or 0 if some value has no inverse (in which
+// case the contents of out are unspecified). m must not be 0.
+int uint256_mod_inv_batch(const UInt256 *in, UInt256 *out, size_t n, UInt256 m) {
+  if (n == 0) {
+    return 1;
+  }
+
+  // out[i] = in[0] * in[1] * ... * in[i]
+  out[0] = uint256_reduce_limbs(in[0].data, 8, m);
+  for (size_t i = 1; i < n; i++) {
+    out[i] = uint256_mulmod(out[i - 1], in[i], m);
+  }
+
+  // inv is the inverse of in[0] * ... * in[i] as i counts down
+  UInt256 inv;
+  if (!uint256_mod_inv(out[n - 1], m, &inv)) {
+    return 0;
+  }
+  for (size_t i = n - 1; i > 0; i--) {
+    UInt256 next = uint256_mulmod(inv, in[i], m);
+    out[i] = uint256_mulmod(inv, out[i - 1], m);
+    inv = next;
+  }
+  out[0] = inv;
+  return 1;
+}
+
+// Number of exponent bits handled per step of uint256_mod_multiexp
+#define UINT256_MULTIEXP_WINDOW 4
+
+// Compute the product of bases[i]^exps[i] (for i from 0 to n-1)
+// modulo m. The squarings are shared between all of the terms
+// (Straus' method), so this is much cheaper than n separate
+// uint256_mod_pow calls. m must not be 0.
+UInt256 uint256_mod_multiexp(const UInt256 *bases, const UInt256 *exps, size_t n, UInt256 m) {
+  const int tableSize = 1 << UINT256_MULTIEXP_WINDOW;
+  UInt256 one = uint256_reduce_limbs(uint256_create_from_u32(1U).data, 8, m);
+
+  // table[i * tableSize + k] = bases[i]^k mod m (unless its size
+  // would overflow a size_t)
+  UInt256 *table = NULL;
+  if (n <= SIZE_MAX / (tableSize * sizeof(UInt256))) {
+    table = malloc(n * tableSize * sizeof(UInt256));
+  }
+  if (n > 0 && table == NULL) {
+    // not enough memory for the tables: fall back to separate powers
+    UInt256 result = one;
+    for (size_t i = 0; i < n; i++) {
+      result = uint256_mulmod(result, uint256_mod_pow(bases[i], exps[i], m), m);
+    }
+    return result;
+  }
+  unsigned maxBits = 0;
+  for (size_t i = 0; i < n; i++) {
+    UInt256 *row = &table[i * tableSize];
+    row[0] = one;
+    row[1] = uint256_reduce_limbs(bases[i].data, 8, m);
+    for (int k = 2; k < tableSize; k++) {
+      row[k] = uint256_mulmod(row[k - 1], row[1], m);
+    }
+    unsigned bits = uint256_bit_length(exps[i]);
+    if (bits > maxBits) {
+      maxBits = bits;
+    }
+  }
+
+  // walk the exponents' windows from the most significant down
+  UInt256 result = one;
+  int numWindows = (maxBits + UINT256_MULTIEXP_WINDOW - 1) / UINT256_MULTIEXP_WINDOW;
+  for (int w = numWindows - 1; w >= 0; w--) {
+    if (w != numWindows - 1) {
+      for (int k = 0; k < UINT256_MULTIEXP_WINDOW; k++) {
+        result = uint256_mulmod(result, result, m);
+      }
+    }
+    unsigned bit = w * UINT256_MULTIEXP_WINDOW;
+    for (size_t i = 0; i < n; i++) {
+      uint32_t digit = (exps[i].data[bit / 32] >> (bit % 32)) & (tableSize - 1);
+      if (digit != 0) {
+        result = uint256_mulmod(result, table[i * tableSize + digit], m);
+      }
+    }
+  }
+
+  free(table);
+  return result;
+}
+
+// Write the decimal digits of val into buf (which must have room for
+// 78 digits plus a null terminator) and return a pointer to the first digit.
+static char *uint256_write_decimal(UInt256 val, char *buf) {
+  char *digit = buf + 78;
+  *digit = '\0';
+  UInt256 billion = uint256_create_from_u32(1000000000U);
+
+  // peel off 9 digits at a time with single-limb divisions
+  do {
+    UInt256 chunk;
+    val = uint256_divmod(val, billion, &chunk);
+    uint32_t digits = chunk.data[0];
+    for (int i = 0; i < 9; i++) {
+      *--digit = '0' + digits % 10;
+      digits /= 10;
+      if (digits == 0 && uint256_is_zero(val)) {
+        break;
+      }
+    }
+  } while (!uint256_is_zero(val));
+  return digit;
+}
+
+// Return a dynamically-allocated string of decimal digits representing
+// the given UInt256 value.
+char *uint256_format_as_decimal(UInt256 val) {
+  UINT256_STATS_BEGIN(UINT256_OP_FORMAT_AS_DECIMAL);
+  char buf[79];  // 2^256 has 78 decimal digits
+  char *digits = uint256_write_decimal(val, buf);
+  char *result = malloc(strlen(digits) + 1);
+  UINT256_STATS_ALLOC(UINT256_OP_FORMAT_AS_DECIMAL, strlen(digits) + 1);
+  strcpy(result, digits);
+  UINT256_STATS_END(UINT256_OP_FORMAT_AS_DECIMAL);
+  return result;
+}
+
+// Return 2^e as a double (for -1022 <= e <= 1023), by building its bits.
+static double uint256_pow2(int e) {
+  uint64_t bits = (uint64_t) (e + 1023) << 52;
+  double result;
+  memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+// Return val converted to the nearest double (ties to even). Values
+// of 2^256 - 2^202 and above round to 2^256.
+double uint256_to_double(UInt256 val) {
+  unsigned len = uint256_bit_length(val);
+  if (len <= 64) {
+    return (double) (((uint64_t) val.data[1] << 32) | val.data[0]);
+  }
+  // keep the top 64 bits, and fold any nonzero bits below them into
+  // bit 0 as a "sticky" bit: it is well below the rounding position
+  // (bit 10), so the conversion still rounds exactly as the full value
+  UInt256 top = uint256_shift_right(val, len - 64);
+  uint64_t bits = ((uint64_t) top.data[1] << 32) | top.data[0];
+  if (uint256_ctz(val) < len - 64) {
+    bits |= 1U;
+  }
+  return (double) bits * uint256_pow2((int) len - 64);
+}
+
+// Return the integer part of d (rounded toward zero). NaN, negative
+// values and values below 1 give 0; values of 2^256 and above give
+// 2^256-1.
+UInt256 uint256_from_double(double d) {
+  UInt256 result = uint256_create_from_u32(0U);
+  if (!(d >= 1.0)) {
+    return result;
+  }
+  if (d >= uint256_pow2(256)) {
+    return uint256_negate(uint256_create_from_u32(1U));
+  }
+  uint64_t bits;
+  memcpy(&bits, &d, sizeof(bits));
+  int exp = (int) ((bits >> 52) & 0x7ff) - 1023;
+  uint64_t mantissa = (bits & ((1ULL << 52) - 1)) | (1ULL << 52);
+  // d is mantissa * 2^(exp - 52)
+  if (exp < 52) {
+    mantissa >>= 52 - exp;
+  }
+  result.data[0] = (uint32_t) mantissa;
+  result.data[1] = (uint32_t) (mantissa >> 32);
+  return exp > 52 ? uint256_shift_left(result, exp - 52) : result;
+}
+
+// 10^k for k up to 77 (10^78 > 2^256)
+#define UINT256_MAX_POW10 77
+
+// Tables of 10^k and of the reciprocals floor((2^256 - 1) / 10^k),
+// filled in on first use
+static UInt256 uint256_pow10_table[UINT256_MAX_POW10 + 1];
+static UInt256 uint256_recip10_table[UINT256_MAX_POW10 + 1];
+static pthread_once_t uint256_pow10_once = PTHREAD_ONCE_INIT;
+
+#ifdef __SIZEOF_INT128__
+// 10^k fits in 64 bits for k up to 19. For those, each 64-bit limb is
+// divided using a precomputed reciprocal of the normalized divisor
+// (Moller and Granlund, "Improved division by invariant integers").
+#define UINT256_MAX_POW10_64 19
+__extension__ typedef unsigned __int128 uint256_u128;
+static uint64_t uint256_recip10_64_table[UINT256_MAX_POW10_64 + 1];
+#endif
+
+static void uint256_init_pow10_tables(void) {
+  UInt256 max = uint256_negate(uint256_create_from_u32(1U));
+  UInt256 power = uint256_create_from_u32(1U);
+  for (int k = 0; k <= UINT256_MAX_POW10; k++) {
+    uint256_pow10_table[k] = power;
+    uint256_recip10_table[k] = uint256_divmod(max, power, NULL);
+    power = uint256_mul(power, uint256_create_from_u32(10U));
+  }
+#ifdef __SIZEOF_INT128__
+  uint64_t divisor = 1U;
+  for (int k = 0; k <= UINT256_MAX_POW10_64; k++) {
+    uint64_t normalized = divisor << __builtin_clzll(divisor);
+    // floor((2^128 - 1) / normalized) - 2^64
+    uint256_recip10_64_table[k] = (uint64_t) (~(uint256_u128) 0 / normalized);
+    divisor *= 10U;
+  }
+#endif
+}
+
+#ifdef __SIZEOF_INT128__
+// Divide val by a 64-bit divisor d, given recip = floor((2^128 - 1) /
+// (d << shift)) - 2^64 where shift normalizes d.
+static UInt256 uint256_divide_u64(UInt256 val, uint64_t d, uint64_t recip, UInt256 *remainder) {
+  int shift = __builtin_clzll(d);
+  d <<= shift;
+
+  uint64_t u[5];
+  for (int i = 0; i < 4; i++) {
+    u[i] = ((uint64_t) val.data[2 * i + 1] << 32) | val.data[2 * i];
+  }
+  u[4] = shift ? u[3] >> (64 - shift) : 0U;
+  for (int i = 3; i > 0 && shift; i--) {
+    u[i] = (u[i] << shift) | (u[i - 1] >> (64 - shift));
+  }
+  u[0] <<= shift;
+
+  UInt256 quotient;
+  uint64_t r = u[4];  // < d, since it holds at most shift bits
+  for (int i = 3; i >= 0; i--) {
+    // estimate the quotient limb from the reciprocal, then correct it
+    uint256_u128 q = (uint256_u128) recip * r;
+    q += ((uint256_u128) (r + 1) << 64) | u[i];
+    uint64_t q1 = (uint64_t) (q >> 64);
+    uint64_t rem = u[i] - q1 * d;
+    if (rem > (uint64_t) q) {
+      q1--;
+      rem += d;
+    }
+    if (rem >= d) {
+      q1++;
+      rem -= d;
+    }
+    quotient.data[2 * i] = (uint32_t) q1;
+    quotient.data[2 * i + 1] = (uint32_t) (q1 >> 32);
+    r = rem;
+  }
+  if (remainder) {
+    *remainder = uint256_create_from_u32(0U);
+    r >>= shift;
+    remainder->data[0] = (uint32_t) r;
+    remainder->data[1] = (uint32_t) (r >> 32);
+  }
+  return quotient;
+}
+#endif
+
+// Compute val / 10^k (rounded down), storing the remainder in
+// *remainder (if remainder is not NULL). This is the usual way to
+// turn a fixed-point amount with k decimal places into its integer
+// part, e.g. k = 18 for token amounts.
+UInt256 uint256_scale_down_pow10(UInt256 val, unsigned k, UInt256 *remainder) {
+  if (k > UINT256_MAX_POW10) {
+    if (remainder) {
+      *remainder = val;
+    }
+    return uint256_create_from_u32(0U);
+  }
+  pthread_once(&uint256_pow10_once, uint256_init_pow10_tables);
+  UInt256 divisor = uint256_pow10_table[k];
+#ifdef __SIZEOF_INT128__
+  if (k <= UINT256_MAX_POW10_64) {
+    uint64_t d = ((uint64_t) divisor.data[1] << 32) | divisor.data[0];
+    return uint256_divide_u64(val, d, uint256_recip10_64_table[k], remainder);
+  }
+#endif
+
+  // multiply by the precomputed reciprocal instead of dividing: the
+  // high half of val * floor((2^256-1) / 10^k) is either the quotient
+  // or one less than it, which a single comparison fixes
+  UInt256 quotient;
+  uint256_muladd(val, uint256_recip10_table[k], uint256_create_from_u32(0U), &quotient);
+  UInt256 rem = uint256_sub(val, uint256_mul(quotient, divisor));
+  if (uint256_compare(rem, divisor) >= 0) {
+    quotient = uint256_add(quotient, uint256_create_from_u32(1U));
+    rem = uint256_sub(rem, divisor);
+  }
+  if (remainder) {
+    *remainder = rem;
+  }
+  return quotient;
+}
+
+// Compute val * 10^k. Returns 1 and stores the product in *result if
+// it fits in 256 bits, otherwise returns 0 and leaves *result unchanged.
+int uint256_scale_up_pow10(UInt256 val, unsigned k, UInt256 *result) {
+  if (k > UINT256_MAX_POW10) {
+    if (!uint256_is_zero(val)) {
+      return 0;
+    }
+    *result = val;
+    return 1;
+  }
+  pthread_once(&uint256_pow10_once, uint256_init_pow10_tables);
+  UInt256 carry;
+  UInt256 product = uint256_muladd(val, uint256_pow10_table[k], uint256_create_from_u32(0U), &carry);
+  if (!uint256_is_zero(carry)) {
+    return 0;
+  }
+  *result = product;
+  return 1;
+}
+
+// Create a UInt256 value holding the two's-complement representation
+// of a signed 64-bit value (i.e., sign-extended to 256 bits).
+UInt256 uint256_create_from_i64(int64_t val) {
+  UInt256 result;
+  uint32_t fill = val < 0 ? 0xffffffffU : 0U;
+  result.data[0] = (uint32_t) val;
+  result.data[1] = (uint32_t) ((uint64_t) val >> 32);
+  for (int i = 2; i <= 7; i++) {
+    result.data[i] = fill;
+  }
+  return result;
+}
+
+// Return 1 if val is negative when interpreted as signed, 0 otherwise.
+int uint256_signed_is_negative(UInt256 val) {
+  return val.data[7] >> 31;
+}
+
+// Compare two signed values. Returns a negative value if left < right,
+// 0 if left == right, and a positive value if left > right.
+int uint256_signed_compare(UInt256 left, UInt256 right) {
+  // flipping the sign bits maps signed order onto unsigned order
+  left.data[7] ^= 0x80000000U;
+  right.data[7] ^= 0x80000000U;
+  return uint256_compare(left, right);
+}
+
+// Return the result of an arithmetic shift of val nbits to the right:
+// vacated bits are filled with copies of the sign bit.
+UInt256 uint256_signed_shift_right(UInt256 val, unsigned nbits) {
+  if (!uint256_signed_is_negative(val)) {
+    return uint256_shift_right(val, nbits);
+  }
+  // for negative values, shift the complement and complement back
+  for (int i = 0; i <= 7; i++) {
+    val.data[i] = ~val.data[i];
+  }
+  UInt256 result = uint256_shift_right(val, nbits);
+  for (int i = 0; i <= 7; i++) {
+    result.data[i] = ~result.data[i];
+  }
+  return result;
+}
+
+// Compute the signed quotient of left / right, rounded toward zero,
+// storing the remainder (which has the sign of left) in *remainder
+// (if remainder is not NULL). right must not be 0. The most negative
+// value divided by -1 wraps back to itself.
+UInt256 uint256_signed_divmod(UInt256 left, UInt256 right, UInt256 *remainder) {
+  int leftNegative = uint256_signed_is_negative(left);
+  int rightNegative = uint256_signed_is_negative(right);
+
+  // divide the magnitudes, then fix up the signs
+  UInt256 quotient = uint256_divmod(leftNegative ? uint256_negate(left) : left,
+                                    rightNegative ? uint256_negate(right) : right,
+                                    remainder);
+  if (leftNegative != rightNegative) {
+    quotient = uint256_negate(quotient);
+  }
+  if (remainder && leftNegative) {
+    *remainder = uint256_negate(*remainder);
+  }
+  return quotient;
+}
+
+// Return a dynamically-allocated string of decimal digits representing
+// the given value interpreted as signed, with a leading '-' if negative.
+char *uint256_signed_format_as_decimal(UInt256 val) {
+  UINT256_STATS_BEGIN(UINT256_OP_FORMAT_AS_DECIMAL);
+  char buf[80];
+  int negative = uint256_signed_is_negative(val);
+  char *digits = uint256_write_decimal(negative ? uint256_negate(val) : val, buf + 1);
+  if (negative) {
+    *--digits = '-';
+  }
+  char *result = malloc(strlen(digits) + 1);
+  UINT256_STATS_ALLOC(UINT256_OP_FORMAT_AS_DECIMAL, strlen(digits) + 1);
+  strcpy(result, digits);
+  UINT256_STATS_END(UINT256_OP_FORMAT_AS_DECIMAL);
+  return result;
+}
+
 // Return the result of rotating every bit in val nbits to
 // the left.  Any bits shifted past the most significant bit
 // should be shifted back into the least significant bits.
@@ -1,8 +1,13 @@
 #ifndef UINT256_H
 #define UINT256_H
 
+#include <stddef.h>
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 // Data type representing a 256-bit unsigned integer, represented
 // as an array of 8 uint32_t values. It is expected that the value
 // at index 0 is the least significant, and the value at index 7
@@ -14,6 +19,56 @@ typedef struct {
   uint32_t data[8];
 } UInt256;
 
+// Accumulator for long chains of UInt256 additions. Each 32-bit limb
+// is summed independently into a 64-bit slot, and carries between
+// limbs are only propagated when the value is read (or once every
+// 2^32-1 additions, before any slot could overflow).
+typedef struct {
+  uint64_t limbs[8];
+  uint32_t count; // additions since the last normalization
+} UInt256Accumulator;
+
+// Hash map from UInt256 keys to uint64_t values (open addressing,
+// Swiss-table style; see uint256_map.c). Treat the fields as private.
+typedef struct {
+  uint8_t *ctrl;      // per-slot control bytes (hash bits or empty/deleted)
+  UInt256 *keys;      // keys stored inline, one per slot
+  uint64_t *values;   // values, one per slot (NULL for a UInt256Set)
+  size_t capacity;    // number of slots (a power of two)
+  size_t size;        // number of keys present
+  size_t growthLeft;  // insertions into empty slots before a rehash
+} UInt256Map;
+
+// Hash set of UInt256 keys, sharing UInt256Map's implementation.
+typedef struct {
+  UInt256Map table;
+} UInt256Set;
+
+// Number of values per block in the compressed column format.
+#define UINT256_COLUMN_BLOCK_SIZE 1024
+
+// Read-only view of a compressed column of UInt256 values (see
+// uint256_column.c for the format). Treat the fields as private.
+typedef struct {
+  const uint8_t *data;  // encoded bytes
+  size_t size;          // number of encoded bytes
+  size_t count;         // number of values
+  size_t numBlocks;     // number of blocks
+  void *mapping;        // mmap'ed file, or NULL for a caller's buffer
+  size_t mappingSize;
+} UInt256Column;
+
+// State of a xoshiro256** pseudo-random generator (see
+// uint256_random.c). Each thread should use its own.
+typedef struct {
+  uint64_t s[4];
+} UInt256Rng;
+
+// Thread pool for bulk jobs, and a handle to one submitted job (see
+// uint256_exec.c). Both are opaque.
+typedef struct UInt256Executor UInt256Executor;
+typedef struct UInt256Job UInt256Job;
+
 // Create a UInt256 value from a single uint32_t value.
 // Only the least-significant 32 bits are initialized directly,
 // all other bits are set to 0.
@@ -36,6 +91,34 @@ char *uint256_format_as_hex(UInt256 val);
 // significant 32 bits.
 uint32_t uint256_get_bits(UInt256 val, unsigned index);
 
+// Return the number of leading (most significant) zero bits in val.
+// Returns 256 if val is 0.
+unsigned uint256_clz(UInt256 val);
+
+// Return the number of trailing (least significant) zero bits in val.
+// Returns 256 if val is 0.
+unsigned uint256_ctz(UInt256 val);
+
+// Return the number of bits set to 1 in val.
+unsigned uint256_popcount(UInt256 val);
+
+// Store the popcount of each of the n values in vals into counts.
+// Uses AVX-512 VPOPCNTQ or POPCNT where the CPU has them.
+void uint256_popcount_n(const UInt256 *vals, size_t n, unsigned *counts);
+
+// Return the number of bits needed to represent val (i.e., the
+// index of the most significant set bit plus one). Returns 0 if
+// val is 0.
+unsigned uint256_bit_length(UInt256 val);
+
+// Return 1 if the bit at the given index (0 is the least significant
+// bit, 255 the most significant) is set, 0 otherwise.
+int uint256_test_bit(UInt256 val, unsigned index);
+
+// Return a copy of val with the bit at the given index set to 1
+// (if bit is nonzero) or cleared to 0 (if bit is zero).
+UInt256 uint256_set_bit(UInt256 val, unsigned index, int bit);
+
 // Compute the sum of two UInt256 values.
 UInt256 uint256_add(UInt256 left, UInt256 right);
 
@@ -44,12 +127,168 @@ UInt256 uint256_sub(UInt256 left, UInt256 right);
 
 // Return the two's-complement negation of the given UInt256 value.
 UInt256 uint256_negate(UInt256 val);
-#if 0
 
-// Not assigning this for Fall 2023
-// Compute the product of two UInt256 values.
+// Compute the product of two UInt256 values. Only the least
+// significant 256 bits of the product are returned.
 UInt256 uint256_mul(UInt256 left, UInt256 right);
-#endif
+
+// Compute a*b+c as a full 512-bit result. The least significant
+// 256 bits are returned, and the most significant 256 bits are
+// stored in *carry (if carry is not NULL).
+UInt256 uint256_muladd(UInt256 a, UInt256 b, UInt256 c, UInt256 *carry);
+
+// Compute the dot product sum(a[i]*b[i]) of two arrays of n values.
+// The sum is accumulated in 512 bits; the least significant 256 bits
+// are returned and the next 256 bits are stored in *hi (if hi is not
+// NULL). Large arrays are split across multiple threads.
+UInt256 uint256_dot_n_wide(const UInt256 *a, const UInt256 *b, size_t n, UInt256 *hi);
+
+// Compute the dot product sum(a[i]*b[i]) of two arrays of n values,
+// wrapping modulo 2^256 like uint256_add.
+UInt256 uint256_dot_n(const UInt256 *a, const UInt256 *b, size_t n);
+
+// Reset an accumulator to hold the value 0.
+void uint256_accumulator_init(UInt256Accumulator *acc);
+
+// Add a UInt256 value to an accumulator.
+void uint256_accumulator_add(UInt256Accumulator *acc, UInt256 val);
+
+// Add an array of n UInt256 values to an accumulator.
+void uint256_accumulator_add_n(UInt256Accumulator *acc, const UInt256 *vals, size_t n);
+
+// Return the accumulated sum, wrapping modulo 2^256 like uint256_add.
+UInt256 uint256_accumulator_value(UInt256Accumulator *acc);
+
+// Compute the sum of n values, wrapping modulo 2^256 like uint256_add.
+// Large arrays are split across multiple threads.
+UInt256 uint256_sum(const UInt256 *vals, size_t n);
+
+// Store the inclusive prefix sums of n values in out, so that out[i]
+// is vals[0] + ... + vals[i] (wrapping modulo 2^256). out may be the
+// same array as vals. Large arrays are scanned by multiple threads in
+// two passes: each thread sums its slice, then each rescans its slice
+// starting from the total of the slices before it. Addition modulo
+// 2^256 is exact, so the result doesn't depend on the number of threads.
+void uint256_prefix_sum(const UInt256 *vals, UInt256 *out, size_t n);
+
+// Return the smallest of n values, or 2^256-1 if n is 0.
+UInt256 uint256_min(const UInt256 *vals, size_t n);
+
+// Return the largest of n values, or 0 if n is 0.
+UInt256 uint256_max(const UInt256 *vals, size_t n);
+
+// Return 1 if val is 0, 0 otherwise.
+int uint256_is_zero(UInt256 val);
+
+// Compare two UInt256 values. Returns a negative value if left < right,
+// 0 if left == right, and a positive value if left > right.
+int uint256_compare(UInt256 left, UInt256 right);
+
+// Return the result of shifting val nbits to the left. Bits shifted
+// past the most significant bit are discarded. nbits >= 256 gives 0.
+UInt256 uint256_shift_left(UInt256 val, unsigned nbits);
+
+// Return the result of shifting val nbits to the right. Bits shifted
+// past the least significant bit are discarded. nbits >= 256 gives 0.
+UInt256 uint256_shift_right(UInt256 val, unsigned nbits);
+
+// Compute the quotient of left / right, storing the remainder in
+// *remainder (if remainder is not NULL). right must not be 0.
+UInt256 uint256_divmod(UInt256 left, UInt256 right, UInt256 *remainder);
+
+// Return the integer square root of val (the largest value r such
+// that r*r <= val).
+UInt256 uint256_isqrt(UInt256 val);
+
+// Return the greatest common divisor of two UInt256 values.
+// gcd(x, 0) is x.
+UInt256 uint256_gcd(UInt256 left, UInt256 right);
+
+// Compute base raised to the power exp, wrapping modulo 2^256.
+UInt256 uint256_pow(UInt256 base, uint64_t exp);
+
+// Compute base raised to the power exp. Returns 1 and stores the
+// result in *result if it fits in 256 bits, otherwise returns 0
+// (and *result is left unchanged).
+int uint256_pow_checked(UInt256 base, uint64_t exp, UInt256 *result);
+
+// Compute (left * right) mod m. m must not be 0.
+UInt256 uint256_mulmod(UInt256 left, UInt256 right, UInt256 m);
+
+// Compute base raised to the power exp, modulo m. m must not be 0.
+UInt256 uint256_mod_pow(UInt256 base, UInt256 exp, UInt256 m);
+
+// Compute the inverse of val modulo m (the value x such that
+// val*x mod m == 1). Returns 1 and stores the inverse in *inv if it
+// exists, otherwise returns 0. m must not be 0.
+int uint256_mod_inv(UInt256 val, UInt256 m, UInt256 *inv);
+
+// Compute the inverses modulo m of the n values in "in", storing them
+// in "out" (which must not overlap "in"). Uses Montgomery's
+// trick: one modular inversion plus 3(n-1) modular multiplications.
+// Returns 1 on success, or 0 if some value has no inverse (in which
+// case the contents of out are unspecified). m must not be 0.
+int uint256_mod_inv_batch(const UInt256 *in, UInt256 *out, size_t n, UInt256 m);
+
+// Compute the product of bases[i]^exps[i] (for i from 0 to n-1)
+// modulo m. The squarings are shared between all of the terms
+// (Straus' method), so this is much cheaper than n separate
+// uint256_mod_pow calls. m must not be 0.
+UInt256 uint256_mod_multiexp(const UInt256 *bases, const UInt256 *exps, size_t n, UInt256 m);
+
+// Return a dynamically-allocated string of decimal digits representing
+// the given UInt256 value.
+char *uint256_format_as_decimal(UInt256 val);
+
+// Return val converted to the nearest double (ties to even). Values
+// of 2^256 - 2^202 and above round to 2^256.
+double uint256_to_double(UInt256 val);
+
+// Return the integer part of d (rounded toward zero). NaN, negative
+// values and values below 1 give 0; values of 2^256 and above give
+// 2^256-1.
+UInt256 uint256_from_double(double d);
+
+// Compute val / 10^k (rounded down), storing the remainder in
+// *remainder (if remainder is not NULL). This is the usual way to
+// turn a fixed-point amount with k decimal places into its integer
+// part, e.g. k = 18 for token amounts.
+UInt256 uint256_scale_down_pow10(UInt256 val, unsigned k, UInt256 *remainder);
+
+// Compute val * 10^k. Returns 1 and stores the product in *result if
+// it fits in 256 bits, otherwise returns 0 and leaves *result unchanged.
+int uint256_scale_up_pow10(UInt256 val, unsigned k, UInt256 *result);
+
+// Signed interpretation: the functions below treat a UInt256 as a
+// two's-complement signed 256-bit integer, where the most significant
+// bit is the sign bit. uint256_add, uint256_sub, uint256_mul and
+// uint256_negate already give the correct signed results (wrapping
+// on overflow), so only operations that depend on the sign are here.
+
+// Create a UInt256 value holding the two's-complement representation
+// of a signed 64-bit value (i.e., sign-extended to 256 bits).
+UInt256 uint256_create_from_i64(int64_t val);
+
+// Return 1 if val is negative when interpreted as signed, 0 otherwise.
+int uint256_signed_is_negative(UInt256 val);
+
+// Compare two signed values. Returns a negative value if left < right,
+// 0 if left == right, and a positive value if left > right.
+int uint256_signed_compare(UInt256 left, UInt256 right);
+
+// Return the result of an arithmetic shift of val nbits to the right:
+// vacated bits are filled with copies of the sign bit.
+UInt256 uint256_signed_shift_right(UInt256 val, unsigned nbits);
+
+// Compute the signed quotient of left / right, rounded toward zero,
+// storing the remainder (which has the sign of left) in *remainder
+// (if remainder is not NULL). right must not be 0. The most negative
+// value divided by -1 wraps back to itself.
+UInt256 uint256_signed_divmod(UInt256 left, UInt256 right, UInt256 *remainder);
+
+// Return a dynamically-allocated string of decimal digits representing
+// the given value interpreted as signed, with a leading '-' if negative.
+char *uint256_signed_format_as_decimal(UInt256 val);
 
 // Return the result of rotating every bit in val nbits to
 // the left.  Any bits shifted past the most significant bit
@@ -61,6 +300,249 @@ UInt256 uint256_rotate_left(UInt256 val, unsigned nbits);
 // should be shifted back into the most significant bits.
 UInt256 uint256_rotate_right(UInt256 val, unsigned nbits);
 
+// Constant-time operations, for values that must stay secret (e.g.,
+// key material). These never branch on or index memory by the value
+// of a UInt256 argument, so their timing doesn't depend on it.
+// Conditions and results are 0 or 1 (as uint32_t).
+
+// Return 1 if val is 0, 0 otherwise.
+uint32_t uint256_ct_is_zero(UInt256 val);
+
+// Return 1 if left == right, 0 otherwise.
+uint32_t uint256_ct_eq(UInt256 left, UInt256 right);
+
+// Return 1 if left < right, 0 otherwise.
+uint32_t uint256_ct_lt(UInt256 left, UInt256 right);
+
+// Compare two values. Returns -1 if left < right, 0 if left == right,
+// and 1 if left > right.
+int uint256_ct_compare(UInt256 left, UInt256 right);
+
+// Return a if cond is 1, b if cond is 0.
+UInt256 uint256_ct_select(uint32_t cond, UInt256 a, UInt256 b);
+
+// Swap *a and *b if cond is 1, leave them unchanged if cond is 0.
+void uint256_ct_swap(uint32_t cond, UInt256 *a, UInt256 *b);
+
+// Compute left + right, storing the carry out (0 or 1) in *carry
+// (if carry is not NULL).
+UInt256 uint256_ct_add(UInt256 left, UInt256 right, uint32_t *carry);
+
+// Compute left - right, storing the borrow out (1 if right > left,
+// 0 otherwise) in *borrow (if borrow is not NULL).
+UInt256 uint256_ct_sub(UInt256 left, UInt256 right, uint32_t *borrow);
+
+// Compute (left + right) mod m. left and right must be less than m.
+UInt256 uint256_ct_addmod(UInt256 left, UInt256 right, UInt256 m);
+
+// Compute (left - right) mod m. left and right must be less than m.
+UInt256 uint256_ct_submod(UInt256 left, UInt256 right, UInt256 m);
+
+// Compute (left * right) mod m. m must not be 0. The modulus is
+// treated as public: it only determines a normalization shift and a
+// reciprocal. The reduction then runs a fixed number of steps with
+// masked corrections, whatever left and right are.
+UInt256 uint256_ct_mulmod(UInt256 left, UInt256 right, UInt256 m);
+
+// Return the result of rotating val nbits to the left, without
+// branching on or indexing by nbits.
+UInt256 uint256_ct_rotate_left(UInt256 val, unsigned nbits);
+
+// Create a UInt256 value from a string of exactly 64 hexadecimal
+// digits. The digits are decoded without branching on their values;
+// characters that are not hex digits decode as 0.
+UInt256 uint256_ct_create_from_hex(const char *hex);
+
+// Create an empty map with room for at least expected keys before
+// it needs to grow. Returns 1 on success, 0 if memory ran out.
+int uint256_map_init(UInt256Map *map, size_t expected);
+
+// Free the memory used by a map.
+void uint256_map_destroy(UInt256Map *map);
+
+// Associate value with key, replacing any existing value. Returns 1
+// if the key was added, 0 if it was already present, and -1 if memory
+// ran out (in which case the map is unchanged).
+int uint256_map_put(UInt256Map *map, UInt256 key, uint64_t value);
+
+// Look up key. Returns 1 and stores its value in *value (if value is
+// not NULL) if the key is present, otherwise returns 0.
+int uint256_map_get(const UInt256Map *map, UInt256 key, uint64_t *value);
+
+// Look up n keys at once, overlapping their memory accesses. For each
+// i, found[i] is set to 1 if keys[i] is present (and its value stored
+// in values[i]) or 0 if not (and values[i] is left unchanged).
+void uint256_map_get_batch(const UInt256Map *map, const UInt256 *keys, size_t n,
+                           uint64_t *values, unsigned char *found);
+
+// Remove key from the map. Returns 1 if it was present, 0 otherwise.
+int uint256_map_remove(UInt256Map *map, UInt256 key);
+
+// Return the number of keys in the map.
+size_t uint256_map_size(const UInt256Map *map);
+
+// Create an empty set with room for at least expected keys before
+// it needs to grow. Returns 1 on success, 0 if memory ran out.
+int uint256_set_init(UInt256Set *set, size_t expected);
+
+// Free the memory used by a set.
+void uint256_set_destroy(UInt256Set *set);
+
+// Add key to the set. Returns 1 if it was added, 0 if it was already
+// present, and -1 if memory ran out (in which case the set is unchanged).
+int uint256_set_add(UInt256Set *set, UInt256 key);
+
+// Return 1 if key is in the set, 0 otherwise.
+int uint256_set_contains(const UInt256Set *set, UInt256 key);
+
+// Check n keys at once, overlapping their memory accesses. found[i]
+// is set to 1 if keys[i] is in the set, 0 otherwise.
+void uint256_set_contains_batch(const UInt256Set *set, const UInt256 *keys, size_t n,
+                                unsigned char *found);
+
+// Remove key from the set. Returns 1 if it was present, 0 otherwise.
+int uint256_set_remove(UInt256Set *set, UInt256 key);
+
+// Return the number of keys in the set.
+size_t uint256_set_size(const UInt256Set *set);
+
+// Return an upper bound on the encoded size of n values.
+size_t uint256_column_encoded_size_bound(size_t n);
+
+// Encode n values into out, which must have room for
+// uint256_column_encoded_size_bound(n) bytes. Returns the number of
+// bytes written.
+size_t uint256_column_encode(const UInt256 *vals, size_t n, void *out);
+
+// Encode n values and write them to the file at path (replacing it).
+// Returns 1 on success, 0 on failure.
+int uint256_column_write(const char *path, const UInt256 *vals, size_t n);
+
+// Open encoded data already in memory. The data must stay valid until
+// the column is closed. Returns 1 on success, 0 if the data is not a
+// well-formed column.
+int uint256_column_open_buffer(UInt256Column *col, const void *data, size_t size);
+
+// Open the column file at path by memory-mapping it. Returns 1 on
+// success, 0 on failure.
+int uint256_column_open(UInt256Column *col, const char *path);
+
+// Release a column (unmapping its file, if it was opened from one).
+void uint256_column_close(UInt256Column *col);
+
+// Decode block number "block" into out (which must have room for
+// UINT256_COLUMN_BLOCK_SIZE values). Returns the number of values in
+// the block, or 0 if the block is malformed.
+size_t uint256_column_decode_block(const UInt256Column *col, size_t block, UInt256 *out);
+
+// Decode every value in the column into out (which must have room for
+// uint256_column_count values). Returns 1 on success, 0 if the column
+// is malformed.
+int uint256_column_decode(const UInt256Column *col, UInt256 *out);
+
+// Return the number of values in a column.
+size_t uint256_column_count(const UInt256Column *col);
+
+// Seed a generator. The same seed always produces the same sequence.
+void uint256_rng_seed(UInt256Rng *rng, uint64_t seed);
+
+// Advance a generator by 2^128 steps. Seeding one generator and
+// jumping it once per thread gives each thread its own reproducible,
+// non-overlapping stream.
+void uint256_rng_jump(UInt256Rng *rng);
+
+// Return a uniformly random UInt256 value. Not suitable for secrets.
+UInt256 uint256_random(UInt256Rng *rng);
+
+// Fill out with n uniformly random values (the same values n calls
+// to uint256_random would return).
+void uint256_random_fill(UInt256Rng *rng, UInt256 *out, size_t n);
+
+// Return a uniformly random value less than bound, or a uniformly
+// random value of any size if bound is 0.
+UInt256 uint256_random_below(UInt256Rng *rng, UInt256 bound);
+
+// Compute the SHA-256 digest of the len bytes at data, as a UInt256.
+// The digest is read as a big-endian number, so the result is the
+// same as uint256_create_from_hex of the hex digest.
+UInt256 uint256_from_sha256(const void *data, size_t len);
+
+// Compute the Keccak-256 digest (the original Keccak padding, as used
+// by Ethereum, not the SHA3-256 padding) of the len bytes at data, as
+// a UInt256 (read big-endian, like uint256_from_sha256).
+UInt256 uint256_from_keccak256(const void *data, size_t len);
+
+// Compute the SHA-256 digests of n messages (data[i] holding lens[i]
+// bytes) into out. Uses the SHA extensions if the CPU has them, and
+// otherwise hashes 8 messages at a time with AVX2 where available.
+void uint256_from_sha256_batch(const void *const *data, const size_t *lens, size_t n, UInt256 *out);
+
+// Compute the Keccak-256 digests of n messages (data[i] holding lens[i]
+// bytes) into out, hashing 4 messages at a time with AVX2 where
+// available.
+void uint256_from_keccak256_batch(const void *const *data, const size_t *lens, size_t n, UInt256 *out);
+
+// Create an executor with numThreads worker threads (or one per
+// processor if numThreads is 0). On Linux, worker i is pinned to the
+// i-th processor this process may run on (wrapping around). Returns
+// NULL if the threads or memory could not be allocated.
+UInt256Executor *uint256_executor_create(unsigned numThreads);
+
+// Wait for every submitted job to finish, then stop the worker threads
+// and free the executor.
+void uint256_executor_destroy(UInt256Executor *exec);
+
+// Submit a job computing the sum of n values (wrapping modulo 2^256)
+// into *result. The optional callback is called with callbackArg on a
+// worker thread once the result is stored. vals and result must stay
+// valid until the job is done. Returns the job, or NULL if memory ran
+// out. Every job must be passed to uint256_job_wait or
+// uint256_job_detach.
+UInt256Job *uint256_executor_submit_sum(UInt256Executor *exec, const UInt256 *vals, size_t n,
+                                        UInt256 *result, void (*callback)(void *arg), void *callbackArg);
+
+// Submit a job computing out[i] = bases[i]^exps[i] mod m for n values
+// (m must not be 0). Otherwise as uint256_executor_submit_sum.
+UInt256Job *uint256_executor_submit_mod_pow(UInt256Executor *exec, const UInt256 *bases, const UInt256 *exps,
+                                            size_t n, UInt256 m, UInt256 *out,
+                                            void (*callback)(void *arg), void *callbackArg);
+
+// Submit a job parsing n hex strings (as uint256_create_from_hex) into
+// out. Otherwise as uint256_executor_submit_sum.
+UInt256Job *uint256_executor_submit_parse_hex(UInt256Executor *exec, const char *const *hex, size_t n,
+                                              UInt256 *out, void (*callback)(void *arg), void *callbackArg);
+
+// Submit a job calling fn(ctx, begin, end) for consecutive ranges of
+// at most tileSize indices covering 0..n-1, possibly on several
+// threads at once. Otherwise as uint256_executor_submit_sum.
+UInt256Job *uint256_executor_submit_for(UInt256Executor *exec, size_t n, size_t tileSize,
+                                        void (*fn)(void *ctx, size_t begin, size_t end), void *ctx,
+                                        void (*callback)(void *arg), void *callbackArg);
+
+// Return 1 if a job has finished (including its callback), 0 if not.
+int uint256_job_done(UInt256Job *job);
+
+// Wait for a job to finish, then release it (the job must not be used
+// afterwards).
+void uint256_job_wait(UInt256Job *job);
+
+// Release a job without waiting for it; it is freed once it finishes.
+// Use the callback to find out when that is.
+void uint256_job_detach(UInt256Job *job);
+
+// Return a dynamically-allocated JSON string with per-operation call
+// counts, bytes allocated and sampled latency histograms, summed over
+// all threads. Counters are only kept when the library is built with
+// UINT256_STATS defined; otherwise the JSON is {"enabled":false}.
+char *uint256_stats_dump(void);
+
+// Reset all UINT256_STATS counters to zero.
+void uint256_stats_reset(void);
+
 // You may add additional functions if you would like to
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif // UINT256_H
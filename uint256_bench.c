@@ -0,0 +1,410 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "uint256.h"
+
+// Benchmark workload for the uint256 library. Each benchmark runs one
+// operation over an array of pseudo-random values and reports the
+// average time per operation. This is also the training workload for
+// the PGO build profile (see the Makefile), so it should exercise the
+// same operations real callers use.
+//
+// Usage: uint256_bench [num_values] [benchmark_name_prefix]
+
+#define DEFAULT_NUM_VALUES 100000
+
+typedef struct {
+  const char *name;
+  // run the operation over n values, return a checksum so the work
+  // can't be optimized away
+  uint32_t (*run)(const UInt256 *a, const UInt256 *b, size_t n);
+  // optional untimed setup and cleanup around run
+  void (*setup)(const UInt256 *a, size_t n);
+  void (*teardown)(void);
+} Benchmark;
+
+// seed for the input arrays, fixed so checksums are reproducible
+#define BENCH_SEED 0x9e3779b97f4a7c15U
+
+static uint32_t bench_create_from_hex(const UInt256 *a, const UInt256 *b, size_t n) {
+  (void) b;
+  // parsing needs hex input, so this times a format + parse round trip
+  uint32_t check = 0U;
+  for (size_t i = 0; i < n; i++) {
+    char *hex = uint256_format_as_hex(a[i]);
+    check ^= uint256_create_from_hex(hex).data[0];
+    free(hex);
+  }
+  return check;
+}
+
+static uint32_t bench_format_as_decimal(const UInt256 *a, const UInt256 *b, size_t n) {
+  (void) b;
+  uint32_t check = 0U;
+  for (size_t i = 0; i < n; i++) {
+    char *dec = uint256_format_as_decimal(a[i]);
+    check ^= (uint32_t) dec[0];
+    free(dec);
+  }
+  return check;
+}
+
+static uint32_t bench_random_fill(const UInt256 *a, const UInt256 *b, size_t n) {
+  (void) a;
+  (void) b;
+  // fill a scratch block over and over, so this measures the generator
+  // rather than page faults
+  UInt256 out[1024];
+  UInt256Rng rng;
+  uint256_rng_seed(&rng, BENCH_SEED);
+  uint32_t check = 0U;
+  for (size_t i = 0; i < n; i += 1024) {
+    size_t count = n - i < 1024 ? n - i : 1024;
+    uint256_random_fill(&rng, out, count);
+    check ^= out[0].data[0];
+  }
+  return check;
+}
+
+static uint32_t bench_add(const UInt256 *a, const UInt256 *b, size_t n) {
+  UInt256 sum = uint256_create_from_u32(0U);
+  for (size_t i = 0; i < n; i++) {
+    sum = uint256_add(sum, uint256_add(a[i], b[i]));
+  }
+  return sum.data[0];
+}
+
+static uint32_t bench_accumulator(const UInt256 *a, const UInt256 *b, size_t n) {
+  (void) b;
+  UInt256Accumulator acc;
+  uint256_accumulator_init(&acc);
+  uint256_accumulator_add_n(&acc, a, n);
+  return uint256_accumulator_value(&acc).data[0];
+}
+
+static uint32_t bench_sum(const UInt256 *a, const UInt256 *b, size_t n) {
+  (void) b;
+  return uint256_sum(a, n).data[0];
+}
+
+static uint32_t bench_prefix_sum(const UInt256 *a, const UInt256 *b, size_t n) {
+  (void) b;
+  UInt256 *out = malloc(n * sizeof(UInt256));
+  if (out == NULL) {
+    return 0U;
+  }
+  uint256_prefix_sum(a, out, n);
+  uint32_t check = n > 0 ? out[n - 1].data[0] : 0U;
+  free(out);
+  return check;
+}
+
+static uint32_t bench_max(const UInt256 *a, const UInt256 *b, size_t n) {
+  (void) b;
+  return uint256_max(a, n).data[0];
+}
+
+static uint32_t bench_mul(const UInt256 *a, const UInt256 *b, size_t n) {
+  uint32_t check = 0U;
+  for (size_t i = 0; i < n; i++) {
+    check ^= uint256_mul(a[i], b[i]).data[7];
+  }
+  return check;
+}
+
+static uint32_t bench_dot_n(const UInt256 *a, const UInt256 *b, size_t n) {
+  return uint256_dot_n(a, b, n).data[0];
+}
+
+static uint32_t bench_divmod(const UInt256 *a, const UInt256 *b, size_t n) {
+  uint32_t check = 0U;
+  for (size_t i = 0; i < n; i++) {
+    // use a divisor about half as wide as the dividend
+    UInt256 divisor = uint256_shift_right(b[i], 128);
+    if (uint256_is_zero(divisor)) {
+      continue;
+    }
+    check ^= uint256_divmod(a[i], divisor, NULL).data[0];
+  }
+  return check;
+}
+
+// 2^255 - 19, a typical cryptographic prime
+static UInt256 bench_modulus(void) {
+  return uint256_create_from_hex("7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed");
+}
+
+static uint32_t bench_mulmod(const UInt256 *a, const UInt256 *b, size_t n) {
+  UInt256 m = bench_modulus();
+  uint32_t check = 0U;
+  for (size_t i = 0; i < n; i++) {
+    check ^= uint256_mulmod(a[i], b[i], m).data[0];
+  }
+  return check;
+}
+
+static uint32_t bench_ct_mulmod(const UInt256 *a, const UInt256 *b, size_t n) {
+  UInt256 m = bench_modulus();
+  uint32_t check = 0U;
+  for (size_t i = 0; i < n; i++) {
+    check ^= uint256_ct_mulmod(a[i], b[i], m).data[0];
+  }
+  return check;
+}
+
+static uint32_t bench_scale_down_pow10(const UInt256 *a, const UInt256 *b, size_t n) {
+  (void) b;
+  uint32_t check = 0U;
+  for (size_t i = 0; i < n; i++) {
+    check ^= uint256_scale_down_pow10(a[i], 18, NULL).data[0];
+  }
+  return check;
+}
+
+static uint32_t bench_to_double(const UInt256 *a, const UInt256 *b, size_t n) {
+  (void) b;
+  double sum = 0.0;
+  for (size_t i = 0; i < n; i++) {
+    sum += uint256_to_double(a[i]);
+  }
+  return (uint32_t) (sum * 0x1p-250);
+}
+
+static uint32_t bench_isqrt(const UInt256 *a, const UInt256 *b, size_t n) {
+  (void) b;
+  uint32_t check = 0U;
+  for (size_t i = 0; i < n; i++) {
+    check ^= uint256_isqrt(a[i]).data[0];
+  }
+  return check;
+}
+
+static uint32_t bench_gcd(const UInt256 *a, const UInt256 *b, size_t n) {
+  uint32_t check = 0U;
+  for (size_t i = 0; i < n; i++) {
+    check ^= uint256_gcd(a[i], b[i]).data[0];
+  }
+  return check;
+}
+
+static uint32_t bench_sha256(const UInt256 *a, const UInt256 *b, size_t n) {
+  (void) b;
+  uint32_t check = 0U;
+  for (size_t i = 0; i < n; i++) {
+    check ^= uint256_from_sha256(&a[i], sizeof(UInt256)).data[0];
+  }
+  return check;
+}
+
+static uint32_t bench_keccak256(const UInt256 *a, const UInt256 *b, size_t n) {
+  (void) b;
+  uint32_t check = 0U;
+  for (size_t i = 0; i < n; i++) {
+    check ^= uint256_from_keccak256(&a[i], sizeof(UInt256)).data[0];
+  }
+  return check;
+}
+
+// hash each value (as 32 bytes) in batches of 64 messages
+static uint32_t bench_hash_batch(const UInt256 *a, size_t n, int keccak) {
+  const void *msgs[64];
+  size_t lens[64];
+  UInt256 out[64];
+  uint32_t check = 0U;
+  for (size_t i = 0; i < n; i += 64) {
+    size_t count = n - i < 64 ? n - i : 64;
+    for (size_t j = 0; j < count; j++) {
+      msgs[j] = &a[i + j];
+      lens[j] = sizeof(UInt256);
+    }
+    if (keccak) {
+      uint256_from_keccak256_batch(msgs, lens, count, out);
+    } else {
+      uint256_from_sha256_batch(msgs, lens, count, out);
+    }
+    check ^= out[0].data[0];
+  }
+  return check;
+}
+
+static uint32_t bench_sha256_batch(const UInt256 *a, const UInt256 *b, size_t n) {
+  (void) b;
+  return bench_hash_batch(a, n, 0);
+}
+
+static uint32_t bench_keccak256_batch(const UInt256 *a, const UInt256 *b, size_t n) {
+  (void) b;
+  return bench_hash_batch(a, n, 1);
+}
+
+// map used by the lookup benchmarks, holding every value in a
+static UInt256Map benchMap;
+
+static void bench_map_setup(const UInt256 *a, size_t n) {
+  if (!uint256_map_init(&benchMap, n)) {
+    fprintf(stderr, "Error: could not allocate map for %zu keys\n", n);
+    exit(1);
+  }
+  for (size_t i = 0; i < n; i++) {
+    uint256_map_put(&benchMap, a[i], i);
+  }
+}
+
+static void bench_map_teardown(void) {
+  uint256_map_destroy(&benchMap);
+}
+
+static uint32_t bench_map_put(const UInt256 *a, const UInt256 *b, size_t n) {
+  (void) b;
+  UInt256Map map;
+  // start small so the timing includes growing the table
+  if (!uint256_map_init(&map, 0)) {
+    return 0U;
+  }
+  for (size_t i = 0; i < n; i++) {
+    uint256_map_put(&map, a[i], i);
+  }
+  uint32_t check = (uint32_t) uint256_map_size(&map);
+  uint256_map_destroy(&map);
+  return check;
+}
+
+static uint32_t bench_map_get(const UInt256 *a, const UInt256 *b, size_t n) {
+  (void) b;
+  uint32_t check = 0U;
+  for (size_t i = 0; i < n; i++) {
+    uint64_t value = 0U;
+    uint256_map_get(&benchMap, a[i], &value);
+    check += (uint32_t) value;
+  }
+  return check;
+}
+
+static uint32_t bench_map_get_batch(const UInt256 *a, const UInt256 *b, size_t n) {
+  (void) b;
+  // batches of 256 lookups
+  uint64_t values[256];
+  unsigned char found[256];
+  uint32_t check = 0U;
+  for (size_t i = 0; i < n; i += 256) {
+    size_t count = n - i < 256 ? n - i : 256;
+    uint256_map_get_batch(&benchMap, a + i, count, values, found);
+    for (size_t j = 0; j < count; j++) {
+      check += (uint32_t) values[j];
+    }
+  }
+  return check;
+}
+
+// column holding the low 64 bits of every value in a
+static unsigned char *benchColumn;
+static size_t benchColumnSize;
+
+static void bench_column_setup(const UInt256 *a, size_t n) {
+  UInt256 *low = malloc(n * sizeof(UInt256));
+  benchColumn = malloc(uint256_column_encoded_size_bound(n));
+  if ((n > 0 && low == NULL) || benchColumn == NULL) {
+    fprintf(stderr, "Error: could not allocate column for %zu values\n", n);
+    exit(1);
+  }
+  for (size_t i = 0; i < n; i++) {
+    low[i] = uint256_shift_right(a[i], 192);
+  }
+  benchColumnSize = uint256_column_encode(low, n, benchColumn);
+  free(low);
+}
+
+static void bench_column_teardown(void) {
+  free(benchColumn);
+}
+
+static uint32_t bench_column_decode(const UInt256 *a, const UInt256 *b, size_t n) {
+  (void) a;
+  (void) b;
+  UInt256 out[UINT256_COLUMN_BLOCK_SIZE];
+  UInt256Column col;
+  uint32_t check = 0U;
+  if (!uint256_column_open_buffer(&col, benchColumn, benchColumnSize)) {
+    return 0U;
+  }
+  for (size_t block = 0; block * UINT256_COLUMN_BLOCK_SIZE < n; block++) {
+    size_t count = uint256_column_decode_block(&col, block, out);
+    for (size_t i = 0; i < count; i++) {
+      check += out[i].data[0];
+    }
+  }
+  uint256_column_close(&col);
+  return check;
+}
+
+static const Benchmark benchmarks[] = {
+  { "hex_round_trip", bench_create_from_hex, NULL, NULL },
+  { "format_as_decimal", bench_format_as_decimal, NULL, NULL },
+  { "random_fill", bench_random_fill, NULL, NULL },
+  { "add", bench_add, NULL, NULL },
+  { "accumulator", bench_accumulator, NULL, NULL },
+  { "sum", bench_sum, NULL, NULL },
+  { "prefix_sum", bench_prefix_sum, NULL, NULL },
+  { "max", bench_max, NULL, NULL },
+  { "mul", bench_mul, NULL, NULL },
+  { "dot_n", bench_dot_n, NULL, NULL },
+  { "divmod", bench_divmod, NULL, NULL },
+  { "mulmod", bench_mulmod, NULL, NULL },
+  { "ct_mulmod", bench_ct_mulmod, NULL, NULL },
+  { "scale_down_pow10", bench_scale_down_pow10, NULL, NULL },
+  { "to_double", bench_to_double, NULL, NULL },
+  { "isqrt", bench_isqrt, NULL, NULL },
+  { "gcd", bench_gcd, NULL, NULL },
+  { "sha256", bench_sha256, NULL, NULL },
+  { "sha256_batch", bench_sha256_batch, NULL, NULL },
+  { "keccak256", bench_keccak256, NULL, NULL },
+  { "keccak256_batch", bench_keccak256_batch, NULL, NULL },
+  { "map_put", bench_map_put, NULL, NULL },
+  { "map_get", bench_map_get, bench_map_setup, bench_map_teardown },
+  { "map_get_batch", bench_map_get_batch, bench_map_setup, bench_map_teardown },
+  { "column_decode", bench_column_decode, bench_column_setup, bench_column_teardown },
+};
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(int argc, char **argv) {
+  size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_NUM_VALUES;
+  const char *only = argc > 2 ? argv[2] : NULL;
+
+  UInt256 *a = malloc(n * sizeof(UInt256));
+  UInt256 *b = malloc(n * sizeof(UInt256));
+  if (n > 0 && (a == NULL || b == NULL)) {
+    fprintf(stderr, "Error: could not allocate %zu values\n", n);
+    return 1;
+  }
+  UInt256Rng rng;
+  uint256_rng_seed(&rng, BENCH_SEED);
+  uint256_random_fill(&rng, a, n);
+  uint256_random_fill(&rng, b, n);
+
+  for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++) {
+    if (only && strncmp(only, benchmarks[i].name, strlen(only)) != 0) {
+      continue;
+    }
+    if (benchmarks[i].setup) {
+      benchmarks[i].setup(a, n);
+    }
+    double start = now_ns();
+    uint32_t check = benchmarks[i].run(a, b, n);
+    double elapsed = now_ns() - start;
+    if (benchmarks[i].teardown) {
+      benchmarks[i].teardown();
+    }
+    printf("%-20s %10.1f ns/op  (checksum %08x)\n", benchmarks[i].name,
+           n > 0 ? elapsed / n : 0.0, check);
+  }
+
+  free(a);
+  free(b);
+  return 0;
+}
@@ -0,0 +1,422 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "uint256.h"
+
+// Compressed columnar format for arrays of UInt256 values.
+//
+// Layout (all integers little-endian):
+//
+//   header:  "U256COL1", uint64 count, uint64 numBlocks
+//   index:   numBlocks uint64 offsets of each block from the start
+//   blocks:  one per UINT256_COLUMN_BLOCK_SIZE values (the last may
+//            be shorter)
+//
+// Each block encodes its values either directly or as deltas from
+// the previous value (whichever is smaller), and then stores each of
+// the 8 limbs as a separate column:
+//
+//   uint16 count, uint8 encoding, uint8 zeroLimbs
+//   [32 bytes: first value, for ENCODING_DELTA only]
+//   for each limb not marked in the zeroLimbs bitmap:
+//     uint32 reference (the limb's minimum), uint8 bit width
+//   for each limb not marked in the zeroLimbs bitmap:
+//     ceil(count * width / 32) uint32 words of (limb - reference),
+//     packed LSB first
+//
+// Limbs that are zero in every value of the block take no space at
+// all, and small values need only a few bits in their low limbs.
+
+#define COLUMN_MAGIC "U256COL1"
+#define COLUMN_HEADER_SIZE 24
+
+#define ENCODING_DIRECT 0
+#define ENCODING_DELTA 1
+
+// Limb columns of one block, ready to pack.
+typedef struct {
+  uint32_t reference[8];
+  uint8_t width[8];
+  uint8_t zeroLimbs;
+} BlockLayout;
+
+static void put_u16(uint8_t *p, uint16_t v) {
+  p[0] = (uint8_t) v;
+  p[1] = (uint8_t) (v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+  for (int i = 0; i < 4; i++) {
+    p[i] = (uint8_t) (v >> (8 * i));
+  }
+}
+
+static void put_u64(uint8_t *p, uint64_t v) {
+  for (int i = 0; i < 8; i++) {
+    p[i] = (uint8_t) (v >> (8 * i));
+  }
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+  return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+  uint32_t v = 0U;
+  for (int i = 3; i >= 0; i--) {
+    v = (v << 8) | p[i];
+  }
+  return v;
+}
+
+static uint64_t get_u64(const uint8_t *p) {
+  uint64_t v = 0U;
+  for (int i = 7; i >= 0; i--) {
+    v = (v << 8) | p[i];
+  }
+  return v;
+}
+
+// Work out the reference and bit width of each limb column.
+static BlockLayout block_layout(const UInt256 *vals, size_t count) {
+  BlockLayout layout;
+  layout.zeroLimbs = 0;
+  for (int limb = 0; limb < 8; limb++) {
+    uint32_t min = UINT32_MAX;
+    uint32_t bits = 0U;
+    for (size_t i = 0; i < count; i++) {
+      bits |= vals[i].data[limb];
+      if (vals[i].data[limb] < min) {
+        min = vals[i].data[limb];
+      }
+    }
+    if (bits == 0U) {
+      layout.zeroLimbs |= 1U << limb;
+      layout.reference[limb] = 0U;
+      layout.width[limb] = 0;
+      continue;
+    }
+    uint32_t range = 0U;
+    for (size_t i = 0; i < count; i++) {
+      range |= vals[i].data[limb] - min;
+    }
+    layout.reference[limb] = min;
+    layout.width[limb] = range == 0U ? 0 : 32 - __builtin_clz(range);
+  }
+  return layout;
+}
+
+// Return the number of bytes a block with this layout takes.
+static size_t block_size(const BlockLayout *layout, size_t count, int encoding) {
+  size_t size = 4 + (encoding == ENCODING_DELTA ? 32 : 0);
+  for (int limb = 0; limb < 8; limb++) {
+    if (!(layout->zeroLimbs & (1U << limb))) {
+      size += 5 + 4 * ((count * layout->width[limb] + 31) / 32);
+    }
+  }
+  return size;
+}
+
+// Pack count values of the given width (LSB first) into out.
+static void pack_bits(const UInt256 *vals, size_t count, int limb, uint32_t reference,
+                      unsigned width, uint8_t *out) {
+  size_t numWords = (count * width + 31) / 32;
+  memset(out, 0, numWords * 4);
+  for (size_t i = 0; i < count; i++) {
+    uint64_t v = vals[i].data[limb] - reference;
+    size_t bit = i * width;
+    // a value spans at most two words; write it byte by byte
+    for (unsigned done = 0; done < width; ) {
+      size_t byte = (bit + done) / 8;
+      unsigned shift = (bit + done) % 8;
+      out[byte] |= (uint8_t) ((v >> done) << shift);
+      done += 8 - shift;
+    }
+  }
+}
+
+// Encode one block and return its size in bytes.
+static size_t encode_block(const UInt256 *vals, size_t count, uint8_t *out) {
+  // deltas from the previous value; sorted or clustered data has
+  // small deltas even when the values themselves are large
+  UInt256 deltas[UINT256_COLUMN_BLOCK_SIZE];
+  deltas[0] = uint256_create_from_u32(0U);
+  for (size_t i = 1; i < count; i++) {
+    deltas[i] = uint256_sub(vals[i], vals[i - 1]);
+  }
+
+  BlockLayout direct = block_layout(vals, count);
+  BlockLayout delta = block_layout(deltas, count);
+  int encoding = block_size(&delta, count, ENCODING_DELTA) < block_size(&direct, count, ENCODING_DIRECT)
+    ? ENCODING_DELTA : ENCODING_DIRECT;
+  const BlockLayout *layout = encoding == ENCODING_DELTA ? &delta : &direct;
+  const UInt256 *source = encoding == ENCODING_DELTA ? deltas : vals;
+
+  uint8_t *p = out;
+  put_u16(p, (uint16_t) count);
+  p[2] = (uint8_t) encoding;
+  p[3] = layout->zeroLimbs;
+  p += 4;
+  if (encoding == ENCODING_DELTA) {
+    for (int limb = 0; limb < 8; limb++) {
+      put_u32(p + 4 * limb, vals[0].data[limb]);
+    }
+    p += 32;
+  }
+  for (int limb = 0; limb < 8; limb++) {
+    if (!(layout->zeroLimbs & (1U << limb))) {
+      put_u32(p, layout->reference[limb]);
+      p[4] = layout->width[limb];
+      p += 5;
+    }
+  }
+  for (int limb = 0; limb < 8; limb++) {
+    if (!(layout->zeroLimbs & (1U << limb))) {
+      pack_bits(source, count, limb, layout->reference[limb], layout->width[limb], p);
+      p += 4 * ((count * layout->width[limb] + 31) / 32);
+    }
+  }
+  return (size_t) (p - out);
+}
+
+// Return an upper bound on the encoded size of n values.
+size_t uint256_column_encoded_size_bound(size_t n) {
+  size_t numBlocks = (n + UINT256_COLUMN_BLOCK_SIZE - 1) / UINT256_COLUMN_BLOCK_SIZE;
+  // worst case: every limb is 32 bits wide, plus the block headers
+  return COLUMN_HEADER_SIZE + numBlocks * (8 + 4 + 32 + 8 * 5) + n * sizeof(UInt256);
+}
+
+// Encode n values into out, which must have room for
+// uint256_column_encoded_size_bound(n) bytes. Returns the number of
+// bytes written.
+size_t uint256_column_encode(const UInt256 *vals, size_t n, void *out) {
+  uint8_t *base = out;
+  size_t numBlocks = (n + UINT256_COLUMN_BLOCK_SIZE - 1) / UINT256_COLUMN_BLOCK_SIZE;
+  memcpy(base, COLUMN_MAGIC, 8);
+  put_u64(base + 8, n);
+  put_u64(base + 16, numBlocks);
+
+  size_t offset = COLUMN_HEADER_SIZE + numBlocks * 8;
+  for (size_t block = 0; block < numBlocks; block++) {
+    size_t first = block * UINT256_COLUMN_BLOCK_SIZE;
+    size_t count = n - first < UINT256_COLUMN_BLOCK_SIZE ? n - first : UINT256_COLUMN_BLOCK_SIZE;
+    put_u64(base + COLUMN_HEADER_SIZE + block * 8, offset);
+    offset += encode_block(vals + first, count, base + offset);
+  }
+  return offset;
+}
+
+// Encode n values and write them to the file at path (replacing it).
+// Returns 1 on success, 0 on failure.
+int uint256_column_write(const char *path, const UInt256 *vals, size_t n) {
+  void *buf = malloc(uint256_column_encoded_size_bound(n));
+  if (buf == NULL) {
+    return 0;
+  }
+  size_t size = uint256_column_encode(vals, n, buf);
+  FILE *out = fopen(path, "wb");
+  int ok = out != NULL && fwrite(buf, 1, size, out) == size;
+  if (out != NULL && fclose(out) != 0) {
+    ok = 0;
+  }
+  free(buf);
+  return ok;
+}
+
+// Open encoded data already in memory. The data must stay valid until
+// the column is closed. Returns 1 on success, 0 if the data is not a
+// well-formed column.
+int uint256_column_open_buffer(UInt256Column *col, const void *data, size_t size) {
+  const uint8_t *p = data;
+  col->mapping = NULL;
+  col->mappingSize = 0;
+  if (size < COLUMN_HEADER_SIZE || memcmp(p, COLUMN_MAGIC, 8) != 0) {
+    return 0;
+  }
+  uint64_t count = get_u64(p + 8);
+  uint64_t numBlocks = get_u64(p + 16);
+  // the header is untrusted: reject a count that would wrap the block
+  // count computation before comparing it with numBlocks
+  if (count > SIZE_MAX - UINT256_COLUMN_BLOCK_SIZE ||
+      numBlocks != (count + UINT256_COLUMN_BLOCK_SIZE - 1) / UINT256_COLUMN_BLOCK_SIZE ||
+      numBlocks > (size - COLUMN_HEADER_SIZE) / 8) {
+    return 0;
+  }
+  col->data = p;
+  col->size = size;
+  col->count = count;
+  col->numBlocks = numBlocks;
+  return 1;
+}
+
+// Open the column file at path by memory-mapping it. Returns 1 on
+// success, 0 on failure.
+int uint256_column_open(UInt256Column *col, const char *path) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return 0;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return 0;
+  }
+  void *mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    return 0;
+  }
+  if (!uint256_column_open_buffer(col, mapping, st.st_size)) {
+    munmap(mapping, st.st_size);
+    return 0;
+  }
+  col->mapping = mapping;
+  col->mappingSize = st.st_size;
+  return 1;
+}
+
+// Release a column (unmapping its file, if it was opened from one).
+void uint256_column_close(UInt256Column *col) {
+  if (col->mapping) {
+    munmap(col->mapping, col->mappingSize);
+  }
+  col->mapping = NULL;
+  col->data = NULL;
+}
+
+// Unpack count values of the given width into the limb column of out,
+// adding reference back. Byte-aligned widths have their own loops,
+// which the compiler vectorizes; other widths go bit by bit.
+static void unpack_bits(const uint8_t *in, size_t count, unsigned width, uint32_t reference,
+                        int limb, UInt256 *out) {
+  if (width == 0) {
+    for (size_t i = 0; i < count; i++) {
+      out[i].data[limb] = reference;
+    }
+  } else if (width == 8) {
+    for (size_t i = 0; i < count; i++) {
+      out[i].data[limb] = reference + in[i];
+    }
+  } else if (width == 16) {
+    for (size_t i = 0; i < count; i++) {
+      out[i].data[limb] = reference + (uint32_t) (in[2 * i] | (in[2 * i + 1] << 8));
+    }
+  } else if (width == 32) {
+    for (size_t i = 0; i < count; i++) {
+      out[i].data[limb] = reference + get_u32(in + 4 * i);
+    }
+  } else {
+    uint64_t mask = (1ULL << width) - 1;
+    size_t last = (count * width + 31) / 32 * 4;
+    for (size_t i = 0; i < count; i++) {
+      size_t bit = i * width;
+      size_t byte = bit / 8;
+      // each value fits in the 8 bytes from its first byte; near the
+      // end of the data, only load the bytes that are there
+      uint64_t window = 0U;
+      if (byte + 8 <= last) {
+        window = get_u64(in + byte);
+      } else {
+        for (size_t k = 0; byte + k < last; k++) {
+          window |= (uint64_t) in[byte + k] << (8 * k);
+        }
+      }
+      out[i].data[limb] = reference + (uint32_t) ((window >> (bit % 8)) & mask);
+    }
+  }
+}
+
+// Decode block number "block" into out (which must have room for
+// UINT256_COLUMN_BLOCK_SIZE values). Returns the number of values in
+// the block, or 0 if the block is malformed.
+size_t uint256_column_decode_block(const UInt256Column *col, size_t block, UInt256 *out) {
+  if (block >= col->numBlocks) {
+    return 0;
+  }
+  uint64_t offset = get_u64(col->data + COLUMN_HEADER_SIZE + block * 8);
+  size_t expected = block == col->numBlocks - 1
+    ? col->count - block * UINT256_COLUMN_BLOCK_SIZE : UINT256_COLUMN_BLOCK_SIZE;
+  if (offset > col->size || col->size - offset < 4) {
+    return 0;
+  }
+
+  const uint8_t *p = col->data + offset;
+  const uint8_t *end = col->data + col->size;
+  size_t count = get_u16(p);
+  int encoding = p[2];
+  uint8_t zeroLimbs = p[3];
+  p += 4;
+  if (count != expected || encoding > ENCODING_DELTA) {
+    return 0;
+  }
+
+  UInt256 first = uint256_create_from_u32(0U);
+  if (encoding == ENCODING_DELTA) {
+    if (end - p < 32) {
+      return 0;
+    }
+    for (int limb = 0; limb < 8; limb++) {
+      first.data[limb] = get_u32(p + 4 * limb);
+    }
+    p += 32;
+  }
+
+  uint32_t reference[8];
+  uint8_t width[8];
+  for (int limb = 0; limb < 8; limb++) {
+    if (zeroLimbs & (1U << limb)) {
+      continue;
+    }
+    if (end - p < 5 || p[4] > 32) {
+      return 0;
+    }
+    reference[limb] = get_u32(p);
+    width[limb] = p[4];
+    p += 5;
+  }
+
+  for (int limb = 0; limb < 8; limb++) {
+    if (zeroLimbs & (1U << limb)) {
+      for (size_t i = 0; i < count; i++) {
+        out[i].data[limb] = 0U;
+      }
+      continue;
+    }
+    size_t bytes = 4 * ((count * width[limb] + 31) / 32);
+    if ((size_t) (end - p) < bytes) {
+      return 0;
+    }
+    unpack_bits(p, count, width[limb], reference[limb], limb, out);
+    p += bytes;
+  }
+
+  if (encoding == ENCODING_DELTA) {
+    // undo the deltas with a running sum from the first value
+    out[0] = first;
+    for (size_t i = 1; i < count; i++) {
+      out[i] = uint256_add(out[i - 1], out[i]);
+    }
+  }
+  return count;
+}
+
+// Decode every value in the column into out (which must have room for
+// uint256_column_count values). Returns 1 on success, 0 if the column
+// is malformed.
+int uint256_column_decode(const UInt256Column *col, UInt256 *out) {
+  for (size_t block = 0; block < col->numBlocks; block++) {
+    if (uint256_column_decode_block(col, block, out + block * UINT256_COLUMN_BLOCK_SIZE) == 0) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+// Return the number of values in a column.
+size_t uint256_column_count(const UInt256Column *col) {
+  return col->count;
+}
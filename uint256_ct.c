@@ -0,0 +1,296 @@
+#include <string.h>
+#include "uint256.h"
+
+// Constant-time operations for secret values. Nothing in this file
+// branches on, or indexes memory with, the value of a UInt256 argument
+// (lengths and moduli are treated as public). Conditions are
+// turned into all-zeros/all-ones masks and combined with bitwise ops,
+// so the same instructions run whatever the operands are.
+
+// Return 0xffffffff if bit is 1, 0 if bit is 0.
+static uint32_t ct_mask(uint32_t bit) {
+  return -bit;
+}
+
+// Return 1 if val is 0, 0 otherwise.
+uint32_t uint256_ct_is_zero(UInt256 val) {
+  uint32_t bits = 0U;
+  for (int i = 0; i <= 7; i++) {
+    bits |= val.data[i];
+  }
+  // (bits | -bits) has its top bit set exactly when bits != 0
+  return 1U ^ ((bits | -bits) >> 31);
+}
+
+// Return 1 if left == right, 0 otherwise.
+uint32_t uint256_ct_eq(UInt256 left, UInt256 right) {
+  UInt256 diff;
+  for (int i = 0; i <= 7; i++) {
+    diff.data[i] = left.data[i] ^ right.data[i];
+  }
+  return uint256_ct_is_zero(diff);
+}
+
+// Compute left + right, storing the carry out (0 or 1) in *carry
+// (if carry is not NULL).
+UInt256 uint256_ct_add(UInt256 left, UInt256 right, uint32_t *carry) {
+  UInt256 sum;
+  uint64_t temp = 0U;
+  for (int i = 0; i <= 7; i++) {
+    temp = (uint64_t) left.data[i] + right.data[i] + (temp >> 32);
+    sum.data[i] = (uint32_t) temp;
+  }
+  if (carry) {
+    *carry = (uint32_t) (temp >> 32);
+  }
+  return sum;
+}
+
+// Compute left - right, storing the borrow out (1 if right > left,
+// 0 otherwise) in *borrow (if borrow is not NULL).
+UInt256 uint256_ct_sub(UInt256 left, UInt256 right, uint32_t *borrow) {
+  UInt256 diff;
+  uint32_t b = 0U;
+  for (int i = 0; i <= 7; i++) {
+    uint64_t temp = (uint64_t) left.data[i] - right.data[i] - b;
+    diff.data[i] = (uint32_t) temp;
+    b = (uint32_t) (temp >> 63);  //wrapped below zero
+  }
+  if (borrow) {
+    *borrow = b;
+  }
+  return diff;
+}
+
+// Return 1 if left < right, 0 otherwise.
+uint32_t uint256_ct_lt(UInt256 left, UInt256 right) {
+  uint32_t borrow;
+  uint256_ct_sub(left, right, &borrow);
+  return borrow;
+}
+
+// Compare two values. Returns -1 if left < right, 0 if left == right,
+// and 1 if left > right.
+int uint256_ct_compare(UInt256 left, UInt256 right) {
+  return (int) uint256_ct_lt(right, left) - (int) uint256_ct_lt(left, right);
+}
+
+// Return a if cond is 1, b if cond is 0.
+UInt256 uint256_ct_select(uint32_t cond, UInt256 a, UInt256 b) {
+  UInt256 result;
+  uint32_t mask = ct_mask(cond);
+  for (int i = 0; i <= 7; i++) {
+    result.data[i] = (a.data[i] & mask) | (b.data[i] & ~mask);
+  }
+  return result;
+}
+
+// Swap *a and *b if cond is 1, leave them unchanged if cond is 0.
+void uint256_ct_swap(uint32_t cond, UInt256 *a, UInt256 *b) {
+  uint32_t mask = ct_mask(cond);
+  for (int i = 0; i <= 7; i++) {
+    uint32_t diff = (a->data[i] ^ b->data[i]) & mask;
+    a->data[i] ^= diff;
+    b->data[i] ^= diff;
+  }
+}
+
+// Compute (left + right) mod m. left and right must be less than m.
+UInt256 uint256_ct_addmod(UInt256 left, UInt256 right, UInt256 m) {
+  uint32_t carry, borrow;
+  UInt256 sum = uint256_ct_add(left, right, &carry);
+  UInt256 reduced = uint256_ct_sub(sum, m, &borrow);
+  // the sum is >= m if it carried out, or if subtracting m didn't borrow
+  return uint256_ct_select(carry | (borrow ^ 1U), reduced, sum);
+}
+
+// Compute (left - right) mod m. left and right must be less than m.
+UInt256 uint256_ct_submod(UInt256 left, UInt256 right, UInt256 m) {
+  uint32_t borrow;
+  UInt256 diff = uint256_ct_sub(left, right, &borrow);
+  UInt256 wrapped = uint256_ct_add(diff, m, NULL);
+  return uint256_ct_select(borrow, wrapped, diff);
+}
+
+// uint256_ct_mulmod works on the widest limbs the compiler can
+// multiply into a double-width product.
+#ifdef __SIZEOF_INT128__
+typedef uint64_t ct_limb;
+__extension__ typedef unsigned __int128 ct_dlimb;
+#else
+typedef uint32_t ct_limb;
+typedef uint64_t ct_dlimb;
+#endif
+
+#define CT_LIMB_BITS ((int) (8 * sizeof(ct_limb)))
+#define CT_LIMBS (256 / CT_LIMB_BITS)
+
+// Return all ones if a < b, 0 otherwise.
+static ct_limb ct_limb_lt(ct_limb a, ct_limb b) {
+  return -((a ^ ((a ^ b) | ((a - b) ^ b))) >> (CT_LIMB_BITS - 1));
+}
+
+// Return all ones if a == b, 0 otherwise.
+static ct_limb ct_limb_eq(ct_limb a, ct_limb b) {
+  ct_limb diff = a ^ b;
+  return ((diff | -diff) >> (CT_LIMB_BITS - 1)) - 1;
+}
+
+// Divide the two-limb value (hi, lo) by d, where hi < d and the top
+// bit of d is set, using the reciprocal v = floor((B^2-1)/d) - B for
+// limb base B (Moller and Granlund, "Improved division by invariant
+// integers"). The corrections are masked, so no hardware divide or
+// branch sees hi or lo.
+static ct_limb ct_div_2by1(ct_limb hi, ct_limb lo, ct_limb d, ct_limb v) {
+  ct_dlimb q = (ct_dlimb) v * hi + (((ct_dlimb) hi << CT_LIMB_BITS) | lo);
+  ct_limb q1 = (ct_limb) (q >> CT_LIMB_BITS) + 1;
+  ct_limb q0 = (ct_limb) q;
+  ct_limb r = lo - q1 * d;
+  ct_limb mask = ct_limb_lt(q0, r);
+  q1 += mask;
+  r += d & mask;
+  q1 -= ~ct_limb_lt(r, d);
+  return q1;
+}
+
+// Convert a UInt256 value to CT_LIMBS limbs, least significant first.
+static void ct_to_limbs(UInt256 val, ct_limb *limbs) {
+  for (int i = 0; i < CT_LIMBS; i++) {
+    limbs[i] = 0;
+  }
+  for (int i = 0; i < 8; i++) {
+    limbs[i * 32 / CT_LIMB_BITS] |= (ct_limb) val.data[i] << (i * 32 % CT_LIMB_BITS);
+  }
+}
+
+// Compute (left * right) mod m. m must not be 0. The modulus is
+// treated as public: it only determines a normalization shift and a
+// reciprocal. The reduction then runs a fixed number of steps with
+// masked corrections, whatever left and right are.
+UInt256 uint256_ct_mulmod(UInt256 left, UInt256 right, UInt256 m) {
+  // full 512-bit product, with no shortcuts for zero limbs
+  ct_limb a[CT_LIMBS], b[CT_LIMBS], product[2 * CT_LIMBS] = { 0 };
+  ct_to_limbs(left, a);
+  ct_to_limbs(right, b);
+  for (int i = 0; i < CT_LIMBS; i++) {
+    ct_limb carry = 0;
+    for (int j = 0; j < CT_LIMBS; j++) {
+      ct_dlimb temp = (ct_dlimb) a[i] * b[j] + product[i + j] + carry;
+      product[i + j] = (ct_limb) temp;
+      carry = (ct_limb) (temp >> CT_LIMB_BITS);
+    }
+    product[i + CT_LIMBS] = carry;
+  }
+
+  // normalize m so its top bit is set, and shift the product to match:
+  // (x * 2^s) mod (m * 2^s) == (x mod m) * 2^s
+  unsigned shift = 256U - uint256_bit_length(m);
+  ct_limb d[CT_LIMBS];
+  ct_to_limbs(uint256_shift_left(m, shift), d);
+  int limbShift = (int) shift / CT_LIMB_BITS, bitShift = (int) shift % CT_LIMB_BITS;
+  int len = 2 * CT_LIMBS + 1 + limbShift;
+  ct_limb x[3 * CT_LIMBS + 1] = { 0 };
+  for (int i = 0; i < 2 * CT_LIMBS; i++) {
+    x[i + limbShift] |= product[i] << bitShift;
+    if (bitShift != 0) {
+      x[i + limbShift + 1] |= product[i] >> (CT_LIMB_BITS - bitShift);
+    }
+  }
+  ct_limb top = d[CT_LIMBS - 1];
+  ct_limb v = (ct_limb) ((((ct_dlimb) ~top << CT_LIMB_BITS) | (ct_limb) ~(ct_limb) 0) / top);
+
+  // Long division one limb at a time, keeping only the remainder r < d.
+  // The top CT_LIMBS-1 limbs of x are already below d.
+  ct_limb r[CT_LIMBS];
+  for (int i = 0; i < CT_LIMBS - 1; i++) {
+    r[i] = x[len - CT_LIMBS + 1 + i];
+  }
+  r[CT_LIMBS - 1] = 0;
+  for (int j = len - CT_LIMBS; j >= 0; j--) {
+    // n = r * B + x[j]
+    ct_limb n[CT_LIMBS + 1];
+    n[0] = x[j];
+    for (int i = 0; i < CT_LIMBS; i++) {
+      n[i + 1] = r[i];
+    }
+
+    // estimate the quotient limb from the top two limbs of n and d; it
+    // is at most 2 too large (Knuth, TAOCP vol. 2, 4.3.1, Theorem B).
+    // r < d so n's top limb is <= top; if equal, the estimate is B-1
+    ct_limb eq = ct_limb_eq(n[CT_LIMBS], top);
+    ct_limb q = ct_div_2by1(n[CT_LIMBS] & ~eq, n[CT_LIMBS - 1], top, v) | eq;
+
+    // n -= q * d, as a two's complement value (which is > -2d)
+    ct_limb carry = 0, borrow = 0;
+    for (int i = 0; i < CT_LIMBS; i++) {
+      ct_dlimb prod = (ct_dlimb) q * d[i] + carry;
+      carry = (ct_limb) (prod >> CT_LIMB_BITS);
+      ct_dlimb diff = (ct_dlimb) n[i] - (ct_limb) prod - borrow;
+      n[i] = (ct_limb) diff;
+      borrow = (ct_limb) (diff >> (2 * CT_LIMB_BITS - 1));
+    }
+    n[CT_LIMBS] -= carry + borrow;
+
+    // add d back (at most twice) while n is negative
+    for (int fix = 0; fix < 2; fix++) {
+      ct_limb mask = -(n[CT_LIMBS] >> (CT_LIMB_BITS - 1));
+      ct_limb c = 0;
+      for (int i = 0; i < CT_LIMBS; i++) {
+        ct_dlimb sum = (ct_dlimb) n[i] + (d[i] & mask) + c;
+        n[i] = (ct_limb) sum;
+        c = (ct_limb) (sum >> CT_LIMB_BITS);
+      }
+      n[CT_LIMBS] += c;
+    }
+    for (int i = 0; i < CT_LIMBS; i++) {
+      r[i] = n[i];
+    }
+  }
+
+  UInt256 result;
+  for (int i = 0; i < 8; i++) {
+    result.data[i] = (uint32_t) (r[i * 32 / CT_LIMB_BITS] >> (i * 32 % CT_LIMB_BITS));
+  }
+  return uint256_shift_right(result, shift);
+}
+
+// Return the result of rotating val nbits to the left, without
+// branching on or indexing by nbits.
+UInt256 uint256_ct_rotate_left(UInt256 val, unsigned nbits) {
+  // barrel rotator: for each bit of nbits, rotate by that power of two
+  // and keep the result only if the bit is set
+  for (unsigned step = 0; step < 8; step++) {
+    unsigned amount = 1U << step;
+    UInt256 rotated;
+    if (amount < 32) {
+      for (int i = 0; i < 8; i++) {
+        rotated.data[i] = (val.data[i] << amount) | (val.data[(i + 7) % 8] >> (32 - amount));
+      }
+    } else {
+      for (int i = 0; i < 8; i++) {
+        rotated.data[i] = val.data[(i + 8 - amount / 32) % 8];
+      }
+    }
+    val = uint256_ct_select((nbits >> step) & 1U, rotated, val);
+  }
+  return val;
+}
+
+// Create a UInt256 value from a string of exactly 64 hexadecimal
+// digits. The digits are decoded without branching on their values;
+// characters that are not hex digits decode as 0.
+UInt256 uint256_ct_create_from_hex(const char *hex) {
+  UInt256 result;
+  memset(&result, 0, sizeof(result));
+  for (int i = 0; i < 64; i++) {
+    int32_t c = (unsigned char) hex[63 - i];
+    int32_t digit = c - '0';
+    int32_t letter = (c | 0x20) - 'a';
+    // all ones when 0 <= digit < 10 (resp. 0 <= letter < 6)
+    int32_t isDigit = (~digit & (digit - 10)) >> 31;
+    int32_t isLetter = (~letter & (letter - 6)) >> 31;
+    uint32_t nibble = (uint32_t) ((digit & isDigit) | ((letter + 10) & isLetter));
+    result.data[i / 8] |= nibble << ((i % 8) * 4);
+  }
+  return result;
+}
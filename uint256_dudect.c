@@ -0,0 +1,200 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "uint256.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// dudect-style timing leak test for the uint256_ct_* functions.
+//
+// Each target is timed many times on two classes of secret input:
+// class 0 always uses the same fixed value (all zeros), class 1 uses
+// fresh random values. The classes are interleaved at random. A
+// Welch's t-test then compares the two timing distributions; if the
+// running time depends on the secret, |t| grows with the number of
+// measurements. As in dudect, |t| > 4.5 is reported as a leak.
+//
+// A variable-time function (uint256_divmod) is included as a control,
+// to show that the harness does detect leaks on this machine.
+//
+// Usage: uint256_dudect [measurements_per_target]
+
+#define DEFAULT_MEASUREMENTS 200000
+#define LEAK_THRESHOLD 4.5
+
+// Measurements above this percentile are dropped, to filter out
+// interrupts and other noise that affects both classes
+#define CROP_PERCENTILE 0.95
+
+typedef struct {
+  const char *name;
+  int expectConstantTime;
+  // run the operation once on the secret value; returns something
+  // derived from the result so the call can't be optimized away
+  uint32_t (*run)(UInt256 secret);
+} Target;
+
+static UInt256 publicValue;   // non-secret operand used by the targets
+static UInt256 modulus;       // 2^255 - 19
+
+static uint64_t rngState = 0x2545f4914f6cdd1dU;
+
+static uint32_t next_random(void) {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 7;
+  rngState ^= rngState << 17;
+  return (uint32_t) (rngState >> 32);
+}
+
+static uint64_t timestamp(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000U + ts.tv_nsec;
+#endif
+}
+
+static uint32_t run_ct_eq(UInt256 secret) {
+  return uint256_ct_eq(secret, publicValue);
+}
+
+static uint32_t run_ct_compare(UInt256 secret) {
+  return (uint32_t) uint256_ct_compare(secret, publicValue);
+}
+
+static uint32_t run_ct_select(UInt256 secret) {
+  return uint256_ct_select(secret.data[0] & 1U, secret, publicValue).data[3];
+}
+
+static uint32_t run_ct_addmod(UInt256 secret) {
+  secret.data[7] &= 0x7fffffffU;   // keep the secret below the modulus
+  return uint256_ct_addmod(secret, publicValue, modulus).data[0];
+}
+
+static uint32_t run_ct_mulmod(UInt256 secret) {
+  return uint256_ct_mulmod(secret, publicValue, modulus).data[0];
+}
+
+static uint32_t run_ct_rotate_left(UInt256 secret) {
+  return uint256_ct_rotate_left(publicValue, secret.data[0]).data[0];
+}
+
+static uint32_t run_ct_create_from_hex(UInt256 secret) {
+  char hex[65];
+  for (int i = 0; i < 64; i++) {
+    hex[i] = "0123456789abcdef"[(secret.data[i / 8] >> ((i % 8) * 4)) & 0xf];
+  }
+  hex[64] = '\0';
+  return uint256_ct_create_from_hex(hex).data[0];
+}
+
+static uint32_t run_divmod(UInt256 secret) {
+  return uint256_divmod(secret, uint256_create_from_u32(7U), NULL).data[0];
+}
+
+static const Target targets[] = {
+  { "uint256_ct_eq", 1, run_ct_eq },
+  { "uint256_ct_compare", 1, run_ct_compare },
+  { "uint256_ct_select", 1, run_ct_select },
+  { "uint256_ct_addmod", 1, run_ct_addmod },
+  { "uint256_ct_mulmod", 1, run_ct_mulmod },
+  { "uint256_ct_rotate_left", 1, run_ct_rotate_left },
+  { "uint256_ct_create_from_hex", 1, run_ct_create_from_hex },
+  { "uint256_divmod (control)", 0, run_divmod },
+};
+
+static int compare_u64(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *) a;
+  uint64_t y = *(const uint64_t *) b;
+  return x < y ? -1 : x > y;
+}
+
+// Time one target and return Welch's t statistic for the two classes.
+static double measure(const Target *target, size_t n) {
+  UInt256 *inputs = malloc(n * sizeof(UInt256));
+  unsigned char *classes = malloc(n);
+  uint64_t *cycles = malloc(n * sizeof(uint64_t));
+  uint64_t *sorted = malloc(n * sizeof(uint64_t));
+  if (!inputs || !classes || !cycles || !sorted) {
+    fprintf(stderr, "Error: could not allocate %zu measurements\n", n);
+    exit(1);
+  }
+
+  // prepare all inputs up front so the timed loop only runs the target
+  for (size_t i = 0; i < n; i++) {
+    classes[i] = next_random() & 1U;
+    for (int j = 0; j < 8; j++) {
+      inputs[i].data[j] = classes[i] ? next_random() : 0U;
+    }
+  }
+
+  volatile uint32_t sink = 0U;
+  for (size_t i = 0; i < n; i++) {
+    uint64_t start = timestamp();
+    sink ^= target->run(inputs[i]);
+    cycles[i] = timestamp() - start;
+  }
+  (void) sink;
+
+  memcpy(sorted, cycles, n * sizeof(uint64_t));
+  qsort(sorted, n, sizeof(uint64_t), compare_u64);
+  uint64_t cutoff = sorted[(size_t) (CROP_PERCENTILE * (n - 1))];
+
+  // Welch's t-test on the cropped measurements (Welford's online
+  // mean/variance for each class)
+  double mean[2] = { 0.0, 0.0 };
+  double m2[2] = { 0.0, 0.0 };
+  double count[2] = { 0.0, 0.0 };
+  for (size_t i = 0; i < n; i++) {
+    if (cycles[i] > cutoff) {
+      continue;
+    }
+    int c = classes[i];
+    count[c] += 1.0;
+    double delta = cycles[i] - mean[c];
+    mean[c] += delta / count[c];
+    m2[c] += delta * (cycles[i] - mean[c]);
+  }
+
+  free(inputs);
+  free(classes);
+  free(cycles);
+  free(sorted);
+
+  if (count[0] < 2.0 || count[1] < 2.0) {
+    return 0.0;
+  }
+  double var0 = m2[0] / (count[0] - 1.0);
+  double var1 = m2[1] / (count[1] - 1.0);
+  double denom = sqrt(var0 / count[0] + var1 / count[1]);
+  return denom == 0.0 ? 0.0 : (mean[0] - mean[1]) / denom;
+}
+
+int main(int argc, char **argv) {
+  size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_MEASUREMENTS;
+
+  publicValue = uint256_create_from_hex("3f8a2c9e5d7b1046f9e3c2a1b0d4e6f78a9b0c1d2e3f405162738495a6b7c8d9");
+  modulus = uint256_create_from_hex("7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed");
+
+  int unexpected = 0;
+  for (size_t i = 0; i < sizeof(targets) / sizeof(targets[0]); i++) {
+    double t = measure(&targets[i], n);
+    int leak = fabs(t) > LEAK_THRESHOLD;
+    printf("%-28s t = %8.2f  %s\n", targets[i].name, t,
+           leak ? "LEAK" : "no leak detected");
+    if (leak == targets[i].expectConstantTime) {
+      unexpected++;
+    }
+  }
+
+  if (unexpected) {
+    printf("%d target(s) did not behave as expected\n", unexpected);
+  }
+  return unexpected > 0;
+}
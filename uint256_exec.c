@@ -0,0 +1,460 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "uint256.h"
+
+// Executor for bulk UInt256 jobs. Each job is split into tiles (small
+// enough to stay in cache), and the tiles are run by a pool of worker
+// threads, one pinned to each processor.
+//
+// Work stealing: every worker has its own deque of tasks, where a
+// task is a range of tiles of one job. A worker takes tasks from the
+// back of its own deque; when it runs a range of several tiles, it
+// pushes the upper half back and keeps the lower half, so large ranges
+// are split lazily. Idle workers steal from the front of other
+// workers' deques, which is where the largest ranges are. New jobs are
+// handed to the workers round-robin, so concurrent jobs share the pool.
+//
+// The deques are protected by one mutex each; tiles are large enough
+// that the locking doesn't show up next to the work.
+
+// Values per tile for each kind of job
+#define EXEC_SUM_TILE 4096
+#define EXEC_PARSE_HEX_TILE 1024
+#define EXEC_MOD_POW_TILE 16
+
+#define EXEC_INITIAL_DEQUE_SIZE 64
+
+typedef enum {
+  JOB_SUM,
+  JOB_MOD_POW,
+  JOB_PARSE_HEX,
+  JOB_FOR,
+} JobKind;
+
+struct UInt256Job {
+  JobKind kind;
+  size_t n;               // number of values
+  size_t tileSize;        // values per tile
+  size_t numTiles;
+  atomic_size_t tilesLeft;
+
+  // operands (which ones are used depends on the kind)
+  const UInt256 *in;
+  const UInt256 *in2;
+  const char *const *hex;
+  UInt256 *out;
+  UInt256 m;
+  UInt256 *partials;      // JOB_SUM: one sum per tile
+  void (*fn)(void *ctx, size_t begin, size_t end);
+  void *ctx;
+
+  void (*callback)(void *arg);
+  void *callbackArg;
+
+  pthread_mutex_t lock;
+  pthread_cond_t doneCond;
+  int done;
+  atomic_int refs;        // the executor's reference and the caller's
+};
+
+typedef struct {
+  UInt256Job *job;
+  size_t begin, end;      // tile indices
+} Task;
+
+typedef struct {
+  UInt256Executor *exec;
+  pthread_t thread;
+  pthread_mutex_t lock;
+  Task *tasks;            // ring buffer
+  size_t capacity;        // a power of two
+  size_t head, count;     // index of the front task, number of tasks
+} Worker;
+
+struct UInt256Executor {
+  Worker *workers;
+  unsigned numWorkers;
+  unsigned numStarted;       // threads actually running
+  atomic_uint nextWorker;    // round-robin target for new jobs
+  atomic_size_t queued;      // tasks in all deques
+  pthread_mutex_t idleLock;
+  pthread_cond_t idleCond;   // signaled when a task is queued
+  int shuttingDown;
+};
+
+// Push a task onto the back of a worker's deque and wake a sleeping
+// worker. Returns 1 on success, 0 if memory ran out.
+static int exec_push(Worker *worker, Task task) {
+  pthread_mutex_lock(&worker->lock);
+  if (worker->count == worker->capacity) {
+    Task *bigger = malloc(2 * worker->capacity * sizeof(Task));
+    if (bigger == NULL) {
+      pthread_mutex_unlock(&worker->lock);
+      return 0;
+    }
+    for (size_t i = 0; i < worker->count; i++) {
+      bigger[i] = worker->tasks[(worker->head + i) & (worker->capacity - 1)];
+    }
+    free(worker->tasks);
+    worker->tasks = bigger;
+    worker->capacity *= 2;
+    worker->head = 0;
+  }
+  worker->tasks[(worker->head + worker->count) & (worker->capacity - 1)] = task;
+  worker->count++;
+  pthread_mutex_unlock(&worker->lock);
+
+  UInt256Executor *exec = worker->exec;
+  atomic_fetch_add(&exec->queued, 1);
+  pthread_mutex_lock(&exec->idleLock);
+  pthread_cond_signal(&exec->idleCond);
+  pthread_mutex_unlock(&exec->idleLock);
+  return 1;
+}
+
+// Take a task from the back (own deque) or front (stealing) of a
+// worker's deque. Returns 1 if there was one.
+static int exec_take(Worker *worker, int fromBack, Task *task) {
+  pthread_mutex_lock(&worker->lock);
+  int found = worker->count > 0;
+  if (found) {
+    if (fromBack) {
+      *task = worker->tasks[(worker->head + worker->count - 1) & (worker->capacity - 1)];
+    } else {
+      *task = worker->tasks[worker->head];
+      worker->head = (worker->head + 1) & (worker->capacity - 1);
+    }
+    worker->count--;
+  }
+  pthread_mutex_unlock(&worker->lock);
+  if (found) {
+    atomic_fetch_sub(&worker->exec->queued, 1);
+  }
+  return found;
+}
+
+// Drop one reference to a job, freeing it with the last one.
+static void job_release(UInt256Job *job) {
+  if (atomic_fetch_sub(&job->refs, 1) == 1) {
+    pthread_mutex_destroy(&job->lock);
+    pthread_cond_destroy(&job->doneCond);
+    free(job->partials);
+    free(job);
+  }
+}
+
+// Finish a job once all its tiles have run: combine the partial
+// results, run the callback, and wake anyone waiting.
+static void job_complete(UInt256Job *job) {
+  if (job->kind == JOB_SUM) {
+    // add the tiles' sums in order (the result is exact either way)
+    UInt256 sum = uint256_create_from_u32(0U);
+    for (size_t t = 0; t < job->numTiles; t++) {
+      sum = uint256_add(sum, job->partials[t]);
+    }
+    *job->out = sum;
+  }
+  if (job->callback) {
+    job->callback(job->callbackArg);
+  }
+  pthread_mutex_lock(&job->lock);
+  job->done = 1;
+  pthread_cond_broadcast(&job->doneCond);
+  pthread_mutex_unlock(&job->lock);
+  job_release(job);
+}
+
+static void job_run_tile(UInt256Job *job, size_t tile) {
+  size_t begin = tile * job->tileSize;
+  size_t end = begin + job->tileSize < job->n ? begin + job->tileSize : job->n;
+  switch (job->kind) {
+  case JOB_SUM: {
+    UInt256Accumulator acc;
+    uint256_accumulator_init(&acc);
+    uint256_accumulator_add_n(&acc, job->in + begin, end - begin);
+    job->partials[tile] = uint256_accumulator_value(&acc);
+    break;
+  }
+  case JOB_MOD_POW:
+    for (size_t i = begin; i < end; i++) {
+      job->out[i] = uint256_mod_pow(job->in[i], job->in2[i], job->m);
+    }
+    break;
+  case JOB_PARSE_HEX:
+    for (size_t i = begin; i < end; i++) {
+      job->out[i] = uint256_create_from_hex(job->hex[i]);
+    }
+    break;
+  case JOB_FOR:
+    job->fn(job->ctx, begin, end);
+    break;
+  }
+}
+
+// Run a task, splitting off the upper half of its range for other
+// workers to steal until only one tile is left.
+static void exec_run(Worker *self, Task task) {
+  while (task.end - task.begin > 1) {
+    size_t mid = task.begin + (task.end - task.begin) / 2;
+    Task upper = { task.job, mid, task.end };
+    if (!exec_push(self, upper)) {
+      break;  //out of memory: run the whole range here
+    }
+    task.end = mid;
+  }
+  for (size_t tile = task.begin; tile < task.end; tile++) {
+    job_run_tile(task.job, tile);
+  }
+  size_t ran = task.end - task.begin;
+  if (atomic_fetch_sub(&task.job->tilesLeft, ran) == ran) {
+    job_complete(task.job);
+  }
+}
+
+static void *exec_worker_main(void *arg) {
+  Worker *self = arg;
+  UInt256Executor *exec = self->exec;
+  unsigned index = (unsigned) (self - exec->workers);
+  for (;;) {
+    Task task = { NULL, 0, 0 };
+    int found = exec_take(self, 1, &task);
+    for (unsigned i = 1; !found && i < exec->numWorkers; i++) {
+      found = exec_take(&exec->workers[(index + i) % exec->numWorkers], 0, &task);
+    }
+    if (found) {
+      exec_run(self, task);
+      continue;
+    }
+
+    pthread_mutex_lock(&exec->idleLock);
+    while (atomic_load(&exec->queued) == 0 && !exec->shuttingDown) {
+      pthread_cond_wait(&exec->idleCond, &exec->idleLock);
+    }
+    int stop = exec->shuttingDown && atomic_load(&exec->queued) == 0;
+    pthread_mutex_unlock(&exec->idleLock);
+    if (stop) {
+      return NULL;
+    }
+  }
+}
+
+// Create an executor with numThreads worker threads (or one per
+// processor if numThreads is 0). On Linux, worker i is pinned to the
+// i-th processor this process may run on (wrapping around). Returns NULL if the
+// threads or memory could not be allocated.
+UInt256Executor *uint256_executor_create(unsigned numThreads) {
+  // the processors this process may run on
+  int cpuIds[CPU_SETSIZE];
+  int numCpus = 0;
+#ifdef __linux__
+  cpu_set_t allowed;
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &allowed)) {
+        cpuIds[numCpus++] = cpu;
+      }
+    }
+  }
+#endif
+  if (numThreads == 0) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    numThreads = numCpus > 0 ? (unsigned) numCpus : online > 0 ? (unsigned) online : 1U;
+  }
+
+  UInt256Executor *exec = calloc(1, sizeof(UInt256Executor));
+  if (exec == NULL) {
+    return NULL;
+  }
+  exec->workers = calloc(numThreads, sizeof(Worker));
+  if (exec->workers == NULL) {
+    free(exec);
+    return NULL;
+  }
+  pthread_mutex_init(&exec->idleLock, NULL);
+  pthread_cond_init(&exec->idleCond, NULL);
+
+  // set up every deque before starting any thread, since the threads
+  // steal from all of them
+  exec->numWorkers = numThreads;
+  for (unsigned i = 0; i < numThreads; i++) {
+    Worker *worker = &exec->workers[i];
+    worker->exec = exec;
+    worker->capacity = EXEC_INITIAL_DEQUE_SIZE;
+    worker->tasks = malloc(worker->capacity * sizeof(Task));
+    pthread_mutex_init(&worker->lock, NULL);
+  }
+  for (unsigned i = 0; i < numThreads; i++) {
+    Worker *worker = &exec->workers[i];
+    if (worker->tasks == NULL || pthread_create(&worker->thread, NULL, exec_worker_main, worker) != 0) {
+      uint256_executor_destroy(exec);
+      return NULL;
+    }
+    exec->numStarted++;
+#ifdef __linux__
+    if (numCpus > 0) {
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      CPU_SET(cpuIds[i % numCpus], &cpus);
+      pthread_setaffinity_np(worker->thread, sizeof(cpus), &cpus);  //best effort
+    }
+#endif
+  }
+  return exec;
+}
+
+// Wait for every submitted job to finish, then stop the worker threads
+// and free the executor.
+void uint256_executor_destroy(UInt256Executor *exec) {
+  pthread_mutex_lock(&exec->idleLock);
+  exec->shuttingDown = 1;
+  pthread_cond_broadcast(&exec->idleCond);
+  pthread_mutex_unlock(&exec->idleLock);
+  // workers only exit when they find no queued tasks, and a worker that
+  // is still running a task will run any tasks it queues itself, so
+  // every submitted job completes
+  for (unsigned i = 0; i < exec->numStarted; i++) {
+    pthread_join(exec->workers[i].thread, NULL);
+  }
+  for (unsigned i = 0; i < exec->numWorkers; i++) {
+    free(exec->workers[i].tasks);
+    pthread_mutex_destroy(&exec->workers[i].lock);
+  }
+  pthread_mutex_destroy(&exec->idleLock);
+  pthread_cond_destroy(&exec->idleCond);
+  free(exec->workers);
+  free(exec);
+}
+
+// Allocate a job of n values split into tiles of tileSize values.
+static UInt256Job *job_create(JobKind kind, size_t n, size_t tileSize,
+                              void (*callback)(void *arg), void *callbackArg) {
+  UInt256Job *job = calloc(1, sizeof(UInt256Job));
+  if (job == NULL) {
+    return NULL;
+  }
+  job->kind = kind;
+  job->n = n;
+  job->tileSize = tileSize > 0 ? tileSize : 1;
+  job->numTiles = (n + job->tileSize - 1) / job->tileSize;
+  atomic_init(&job->tilesLeft, job->numTiles);
+  job->callback = callback;
+  job->callbackArg = callbackArg;
+  pthread_mutex_init(&job->lock, NULL);
+  pthread_cond_init(&job->doneCond, NULL);
+  atomic_init(&job->refs, 2);
+  return job;
+}
+
+// Queue a job on the next worker (or complete it at once if it has no
+// tiles). Returns the job, or NULL (freeing it) if memory ran out.
+static UInt256Job *job_submit(UInt256Executor *exec, UInt256Job *job) {
+  if (job->numTiles == 0) {
+    job_complete(job);
+    return job;
+  }
+  unsigned target = atomic_fetch_add(&exec->nextWorker, 1) % exec->numWorkers;
+  Task task = { job, 0, job->numTiles };
+  if (!exec_push(&exec->workers[target], task)) {
+    job->refs = 1;
+    job_release(job);
+    return NULL;
+  }
+  return job;
+}
+
+// Submit a job computing the sum of n values (wrapping modulo 2^256)
+// into *result. The optional callback is called with callbackArg on a
+// worker thread once the result is stored. vals and result must stay
+// valid until the job is done. Returns the job, or NULL if memory ran
+// out. Every job must be passed to uint256_job_wait or
+// uint256_job_detach.
+UInt256Job *uint256_executor_submit_sum(UInt256Executor *exec, const UInt256 *vals, size_t n,
+                                        UInt256 *result, void (*callback)(void *arg), void *callbackArg) {
+  UInt256Job *job = job_create(JOB_SUM, n, EXEC_SUM_TILE, callback, callbackArg);
+  if (job == NULL) {
+    return NULL;
+  }
+  job->partials = malloc((job->numTiles > 0 ? job->numTiles : 1) * sizeof(UInt256));
+  if (job->partials == NULL) {
+    job->refs = 1;
+    job_release(job);
+    return NULL;
+  }
+  job->in = vals;
+  job->out = result;
+  return job_submit(exec, job);
+}
+
+// Submit a job computing out[i] = bases[i]^exps[i] mod m for n values
+// (m must not be 0). Otherwise as uint256_executor_submit_sum.
+UInt256Job *uint256_executor_submit_mod_pow(UInt256Executor *exec, const UInt256 *bases, const UInt256 *exps,
+                                            size_t n, UInt256 m, UInt256 *out,
+                                            void (*callback)(void *arg), void *callbackArg) {
+  UInt256Job *job = job_create(JOB_MOD_POW, n, EXEC_MOD_POW_TILE, callback, callbackArg);
+  if (job == NULL) {
+    return NULL;
+  }
+  job->in = bases;
+  job->in2 = exps;
+  job->m = m;
+  job->out = out;
+  return job_submit(exec, job);
+}
+
+// Submit a job parsing n hex strings (as uint256_create_from_hex) into
+// out. Otherwise as uint256_executor_submit_sum.
+UInt256Job *uint256_executor_submit_parse_hex(UInt256Executor *exec, const char *const *hex, size_t n,
+                                              UInt256 *out, void (*callback)(void *arg), void *callbackArg) {
+  UInt256Job *job = job_create(JOB_PARSE_HEX, n, EXEC_PARSE_HEX_TILE, callback, callbackArg);
+  if (job == NULL) {
+    return NULL;
+  }
+  job->hex = hex;
+  job->out = out;
+  return job_submit(exec, job);
+}
+
+// Submit a job calling fn(ctx, begin, end) for consecutive ranges of
+// at most tileSize indices covering 0..n-1, possibly on several
+// threads at once. Otherwise as uint256_executor_submit_sum.
+UInt256Job *uint256_executor_submit_for(UInt256Executor *exec, size_t n, size_t tileSize,
+                                        void (*fn)(void *ctx, size_t begin, size_t end), void *ctx,
+                                        void (*callback)(void *arg), void *callbackArg) {
+  UInt256Job *job = job_create(JOB_FOR, n, tileSize, callback, callbackArg);
+  if (job == NULL) {
+    return NULL;
+  }
+  job->fn = fn;
+  job->ctx = ctx;
+  return job_submit(exec, job);
+}
+
+// Return 1 if a job has finished (including its callback), 0 if not.
+int uint256_job_done(UInt256Job *job) {
+  pthread_mutex_lock(&job->lock);
+  int done = job->done;
+  pthread_mutex_unlock(&job->lock);
+  return done;
+}
+
+// Wait for a job to finish, then release it (the job must not be used
+// afterwards).
+void uint256_job_wait(UInt256Job *job) {
+  pthread_mutex_lock(&job->lock);
+  while (!job->done) {
+    pthread_cond_wait(&job->doneCond, &job->lock);
+  }
+  pthread_mutex_unlock(&job->lock);
+  job_release(job);
+}
+
+// Release a job without waiting for it; it is freed once it finishes.
+// Use the callback to find out when that is.
+void uint256_job_detach(UInt256Job *job) {
+  job_release(job);
+}
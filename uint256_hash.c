@@ -0,0 +1,511 @@
+#include <pthread.h>
+#include <string.h>
+#include "uint256.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define UINT256_HASH_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+// SHA-256 and Keccak-256 digests as UInt256 values. A digest is read
+// as a big-endian number (as its hex string would be), so the result
+// equals uint256_create_from_hex of the hex digest.
+//
+// On x86, the best kernel is picked at run time: SHA-256 uses the SHA
+// extensions if the CPU has them, and otherwise (for batches) hashes
+// 8 messages at once in the 32-bit lanes of AVX2 registers. Keccak-256
+// batches hash 4 messages at once in the 64-bit lanes of AVX2 registers.
+
+#define SHA256_BLOCK 64
+#define KECCAK256_RATE 136
+
+static const uint32_t sha256_k[64] = {
+  0x428a2f98U, 0x71374491U, 0xb5c0fbcfU, 0xe9b5dba5U, 0x3956c25bU, 0x59f111f1U, 0x923f82a4U, 0xab1c5ed5U,
+  0xd807aa98U, 0x12835b01U, 0x243185beU, 0x550c7dc3U, 0x72be5d74U, 0x80deb1feU, 0x9bdc06a7U, 0xc19bf174U,
+  0xe49b69c1U, 0xefbe4786U, 0x0fc19dc6U, 0x240ca1ccU, 0x2de92c6fU, 0x4a7484aaU, 0x5cb0a9dcU, 0x76f988daU,
+  0x983e5152U, 0xa831c66dU, 0xb00327c8U, 0xbf597fc7U, 0xc6e00bf3U, 0xd5a79147U, 0x06ca6351U, 0x14292967U,
+  0x27b70a85U, 0x2e1b2138U, 0x4d2c6dfcU, 0x53380d13U, 0x650a7354U, 0x766a0abbU, 0x81c2c92eU, 0x92722c85U,
+  0xa2bfe8a1U, 0xa81a664bU, 0xc24b8b70U, 0xc76c51a3U, 0xd192e819U, 0xd6990624U, 0xf40e3585U, 0x106aa070U,
+  0x19a4c116U, 0x1e376c08U, 0x2748774cU, 0x34b0bcb5U, 0x391c0cb3U, 0x4ed8aa4aU, 0x5b9cca4fU, 0x682e6ff3U,
+  0x748f82eeU, 0x78a5636fU, 0x84c87814U, 0x8cc70208U, 0x90befffaU, 0xa4506cebU, 0xbef9a3f7U, 0xc67178f2U,
+};
+
+static const uint32_t sha256_init[8] = {
+  0x6a09e667U, 0xbb67ae85U, 0x3c6ef372U, 0xa54ff53aU, 0x510e527fU, 0x9b05688cU, 0x1f83d9abU, 0x5be0cd19U,
+};
+
+static const uint64_t keccak_rc[24] = {
+  0x0000000000000001U, 0x0000000000008082U, 0x800000000000808aU, 0x8000000080008000U,
+  0x000000000000808bU, 0x0000000080000001U, 0x8000000080008081U, 0x8000000000008009U,
+  0x000000000000008aU, 0x0000000000000088U, 0x0000000080008009U, 0x000000008000000aU,
+  0x000000008000808bU, 0x800000000000008bU, 0x8000000000008089U, 0x8000000000008003U,
+  0x8000000000008002U, 0x8000000000000080U, 0x000000000000800aU, 0x800000008000000aU,
+  0x8000000080008081U, 0x8000000000008080U, 0x0000000080000001U, 0x8000000080008008U,
+};
+
+// The combined rho and pi steps: rotate each lane by its fixed amount
+// and move it to its new position. Written out in full so that the
+// rotation amounts are constants and the state can stay in registers.
+#define KECCAK_RHO_PI(b, a, ROTL) \
+  (b)[0] = (a)[0]; (b)[10] = ROTL((a)[1], 1); (b)[20] = ROTL((a)[2], 62); \
+  (b)[5] = ROTL((a)[3], 28); (b)[15] = ROTL((a)[4], 27); (b)[16] = ROTL((a)[5], 36); \
+  (b)[1] = ROTL((a)[6], 44); (b)[11] = ROTL((a)[7], 6); (b)[21] = ROTL((a)[8], 55); \
+  (b)[6] = ROTL((a)[9], 20); (b)[7] = ROTL((a)[10], 3); (b)[17] = ROTL((a)[11], 10); \
+  (b)[2] = ROTL((a)[12], 43); (b)[12] = ROTL((a)[13], 25); (b)[22] = ROTL((a)[14], 39); \
+  (b)[23] = ROTL((a)[15], 41); (b)[8] = ROTL((a)[16], 45); (b)[18] = ROTL((a)[17], 15); \
+  (b)[3] = ROTL((a)[18], 21); (b)[13] = ROTL((a)[19], 8); (b)[14] = ROTL((a)[20], 18); \
+  (b)[24] = ROTL((a)[21], 2); (b)[9] = ROTL((a)[22], 61); (b)[19] = ROTL((a)[23], 56); \
+  (b)[4] = ROTL((a)[24], 14);
+
+// Return the number of SHA-256 blocks in a padded message of len bytes
+// (the message, a 0x80 byte and a 64-bit length).
+static size_t sha256_num_blocks(size_t len) {
+  return (len + 9 + SHA256_BLOCK - 1) / SHA256_BLOCK;
+}
+
+// Return a pointer to block j of the padded message. Blocks that lie
+// entirely in the message are returned in place; the others are built
+// in tmp.
+static const uint8_t *sha256_block(const uint8_t *msg, size_t len, size_t j, uint8_t tmp[SHA256_BLOCK]) {
+  size_t begin = j * SHA256_BLOCK;
+  if (begin + SHA256_BLOCK <= len) {
+    return msg + begin;
+  }
+  memset(tmp, 0, SHA256_BLOCK);
+  if (begin < len) {
+    memcpy(tmp, msg + begin, len - begin);
+  }
+  if (begin <= len) {
+    tmp[len - begin] = 0x80;
+  }
+  if (j == sha256_num_blocks(len) - 1) {
+    uint64_t bits = (uint64_t) len * 8;
+    for (int i = 0; i < 8; i++) {
+      tmp[SHA256_BLOCK - 1 - i] = (uint8_t) (bits >> (8 * i));
+    }
+  }
+  return tmp;
+}
+
+// Return the number of Keccak-256 blocks in a padded message of len
+// bytes (the message, then 0x01, zeros and a final 0x80).
+static size_t keccak256_num_blocks(size_t len) {
+  return len / KECCAK256_RATE + 1;
+}
+
+// Return a pointer to block j of the padded message (as sha256_block).
+static const uint8_t *keccak256_block(const uint8_t *msg, size_t len, size_t j, uint8_t tmp[KECCAK256_RATE]) {
+  size_t begin = j * KECCAK256_RATE;
+  if (begin + KECCAK256_RATE <= len) {
+    return msg + begin;
+  }
+  memset(tmp, 0, KECCAK256_RATE);
+  if (begin < len) {
+    memcpy(tmp, msg + begin, len - begin);
+  }
+  tmp[len - begin] |= 0x01;
+  tmp[KECCAK256_RATE - 1] |= 0x80;
+  return tmp;
+}
+
+static uint32_t load_be32(const uint8_t *p) {
+  return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | p[3];
+}
+
+static uint64_t load_le64(const uint8_t *p) {
+  uint64_t v = 0U;
+  for (int i = 7; i >= 0; i--) {
+    v = (v << 8) | p[i];
+  }
+  return v;
+}
+
+static uint32_t rotr32(uint32_t x, int n) {
+  return (x >> n) | (x << (32 - n));
+}
+
+static uint64_t rotl64(uint64_t x, int n) {
+  return (x << n) | (x >> (64 - n));
+}
+
+// Convert a SHA-256 state to a UInt256: the first word of the digest
+// is the most significant.
+static UInt256 sha256_to_uint256(const uint32_t state[8]) {
+  UInt256 result;
+  for (int i = 0; i < 8; i++) {
+    result.data[7 - i] = state[i];
+  }
+  return result;
+}
+
+// Convert a Keccak state to a UInt256: the digest is the first 32
+// bytes of the (little-endian) lanes, and its first byte is the most
+// significant.
+static UInt256 keccak_to_uint256(const uint64_t state[4]) {
+  UInt256 result;
+  for (int i = 0; i < 4; i++) {
+    result.data[7 - 2 * i] = __builtin_bswap32((uint32_t) state[i]);
+    result.data[6 - 2 * i] = __builtin_bswap32((uint32_t) (state[i] >> 32));
+  }
+  return result;
+}
+
+static void sha256_compress(uint32_t state[8], const uint8_t *block) {
+  uint32_t w[64];
+  for (int t = 0; t < 16; t++) {
+    w[t] = load_be32(block + 4 * t);
+  }
+  for (int t = 16; t < 64; t++) {
+    uint32_t s0 = rotr32(w[t - 15], 7) ^ rotr32(w[t - 15], 18) ^ (w[t - 15] >> 3);
+    uint32_t s1 = rotr32(w[t - 2], 17) ^ rotr32(w[t - 2], 19) ^ (w[t - 2] >> 10);
+    w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+  }
+
+  uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+  uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+  for (int t = 0; t < 64; t++) {
+    uint32_t t1 = h + (rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25)) + ((e & f) ^ (~e & g)) + sha256_k[t] + w[t];
+    uint32_t t2 = (rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+  state[5] += f;
+  state[6] += g;
+  state[7] += h;
+}
+
+static void keccak_f1600(uint64_t st[25]) {
+  uint64_t a[25], b[25];
+  memcpy(a, st, sizeof(a));
+  for (int round = 0; round < 24; round++) {
+    uint64_t bc[5];
+    for (int i = 0; i < 5; i++) {
+      bc[i] = a[i] ^ a[i + 5] ^ a[i + 10] ^ a[i + 15] ^ a[i + 20];
+    }
+    for (int i = 0; i < 5; i++) {
+      uint64_t t = bc[(i + 4) % 5] ^ rotl64(bc[(i + 1) % 5], 1);
+      for (int j = 0; j < 25; j += 5) {
+        a[j + i] ^= t;
+      }
+    }
+
+    KECCAK_RHO_PI(b, a, rotl64);
+
+    for (int j = 0; j < 25; j += 5) {
+      for (int i = 0; i < 5; i++) {
+        a[j + i] = b[j + i] ^ (~b[j + (i + 1) % 5] & b[j + (i + 2) % 5]);
+      }
+    }
+
+    a[0] ^= keccak_rc[round];
+  }
+  memcpy(st, a, sizeof(a));
+}
+
+#ifdef UINT256_HASH_X86
+
+// SHA-256 compression with the SHA extensions (four rounds per pair
+// of sha256rnds2 instructions).
+__attribute__((target("sha,sse4.1")))
+static void sha256_compress_shani(uint32_t state[8], const uint8_t *block) {
+  const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bLL, 0x0405060700010203LL);
+
+  // the instructions want the state as ABEF and CDGH
+  __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) &state[0]), 0xb1);
+  __m128i efgh = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) &state[4]), 0x1b);
+  __m128i abef = _mm_alignr_epi8(abcd, efgh, 8);
+  __m128i cdgh = _mm_blend_epi16(efgh, abcd, 0xf0);
+  __m128i abefSave = abef;
+  __m128i cdghSave = cdgh;
+
+  __m128i w[16];
+  for (int i = 0; i < 16; i++) {
+    if (i < 4) {
+      w[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (block + 16 * i)), byteSwap);
+    } else {
+      __m128i partial = _mm_add_epi32(_mm_sha256msg1_epu32(w[i - 4], w[i - 3]),
+                                      _mm_alignr_epi8(w[i - 1], w[i - 2], 4));
+      w[i] = _mm_sha256msg2_epu32(partial, w[i - 1]);
+    }
+    __m128i msg = _mm_add_epi32(w[i], _mm_loadu_si128((const __m128i *) &sha256_k[4 * i]));
+    cdgh = _mm_sha256rnds2_epu32(cdgh, abef, msg);
+    abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(msg, 0x0e));
+  }
+
+  abef = _mm_add_epi32(abef, abefSave);
+  cdgh = _mm_add_epi32(cdgh, cdghSave);
+  __m128i feba = _mm_shuffle_epi32(abef, 0x1b);
+  __m128i dchg = _mm_shuffle_epi32(cdgh, 0xb1);
+  _mm_storeu_si128((__m128i *) &state[0], _mm_blend_epi16(feba, dchg, 0xf0));
+  _mm_storeu_si128((__m128i *) &state[4], _mm_alignr_epi8(dchg, feba, 8));
+}
+
+#define ROTR8(x, n) _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+
+// Hash 8 messages at once, one per 32-bit lane. Lanes that finish
+// early keep running on dummy blocks; their digest is taken as soon as
+// their last block is done.
+__attribute__((target("avx2")))
+static void sha256_x8(const uint8_t *const *msgs, const size_t *lens, UInt256 *out) {
+  size_t numBlocks[8];
+  size_t maxBlocks = 0;
+  for (int lane = 0; lane < 8; lane++) {
+    numBlocks[lane] = sha256_num_blocks(lens[lane]);
+    if (numBlocks[lane] > maxBlocks) {
+      maxBlocks = numBlocks[lane];
+    }
+  }
+
+  __m256i state[8];
+  for (int i = 0; i < 8; i++) {
+    state[i] = _mm256_set1_epi32((int) sha256_init[i]);
+  }
+
+  uint8_t tmp[8][SHA256_BLOCK];
+  for (size_t j = 0; j < maxBlocks; j++) {
+    const uint8_t *blocks[8];
+    for (int lane = 0; lane < 8; lane++) {
+      blocks[lane] = j < numBlocks[lane] ? sha256_block(msgs[lane], lens[lane], j, tmp[lane]) : tmp[lane];
+    }
+
+    __m256i w[64];
+    for (int t = 0; t < 16; t++) {
+      w[t] = _mm256_setr_epi32((int) load_be32(blocks[0] + 4 * t), (int) load_be32(blocks[1] + 4 * t),
+                               (int) load_be32(blocks[2] + 4 * t), (int) load_be32(blocks[3] + 4 * t),
+                               (int) load_be32(blocks[4] + 4 * t), (int) load_be32(blocks[5] + 4 * t),
+                               (int) load_be32(blocks[6] + 4 * t), (int) load_be32(blocks[7] + 4 * t));
+    }
+    for (int t = 16; t < 64; t++) {
+      __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(ROTR8(w[t - 15], 7), ROTR8(w[t - 15], 18)),
+                                    _mm256_srli_epi32(w[t - 15], 3));
+      __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(ROTR8(w[t - 2], 17), ROTR8(w[t - 2], 19)),
+                                    _mm256_srli_epi32(w[t - 2], 10));
+      w[t] = _mm256_add_epi32(_mm256_add_epi32(w[t - 16], s0), _mm256_add_epi32(w[t - 7], s1));
+    }
+
+    __m256i a = state[0], b = state[1], c = state[2], d = state[3];
+    __m256i e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int t = 0; t < 64; t++) {
+      __m256i sigma1 = _mm256_xor_si256(_mm256_xor_si256(ROTR8(e, 6), ROTR8(e, 11)), ROTR8(e, 25));
+      __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+      __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, sigma1),
+                                    _mm256_add_epi32(ch, _mm256_add_epi32(w[t], _mm256_set1_epi32((int) sha256_k[t]))));
+      __m256i sigma0 = _mm256_xor_si256(_mm256_xor_si256(ROTR8(a, 2), ROTR8(a, 13)), ROTR8(a, 22));
+      __m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+      h = g;
+      g = f;
+      f = e;
+      e = _mm256_add_epi32(d, t1);
+      d = c;
+      c = b;
+      b = a;
+      a = _mm256_add_epi32(t1, _mm256_add_epi32(sigma0, maj));
+    }
+    state[0] = _mm256_add_epi32(state[0], a);
+    state[1] = _mm256_add_epi32(state[1], b);
+    state[2] = _mm256_add_epi32(state[2], c);
+    state[3] = _mm256_add_epi32(state[3], d);
+    state[4] = _mm256_add_epi32(state[4], e);
+    state[5] = _mm256_add_epi32(state[5], f);
+    state[6] = _mm256_add_epi32(state[6], g);
+    state[7] = _mm256_add_epi32(state[7], h);
+
+    uint32_t lanes[8][8];
+    int extracted = 0;
+    for (int lane = 0; lane < 8; lane++) {
+      if (j + 1 != numBlocks[lane]) {
+        continue;
+      }
+      if (!extracted) {
+        for (int i = 0; i < 8; i++) {
+          _mm256_storeu_si256((__m256i *) lanes[i], state[i]);
+        }
+        extracted = 1;
+      }
+      uint32_t digest[8];
+      for (int i = 0; i < 8; i++) {
+        digest[i] = lanes[i][lane];
+      }
+      out[lane] = sha256_to_uint256(digest);
+    }
+  }
+}
+
+#define ROTL4(x, n) _mm256_or_si256(_mm256_slli_epi64(x, n), _mm256_srli_epi64(x, 64 - (n)))
+
+// Keccak-f[1600] on 4 states at once, one per 64-bit lane.
+__attribute__((target("avx2")))
+static void keccak_f1600_x4(__m256i st[25]) {
+  __m256i b[25];
+  for (int round = 0; round < 24; round++) {
+    __m256i bc[5];
+    for (int i = 0; i < 5; i++) {
+      bc[i] = _mm256_xor_si256(_mm256_xor_si256(st[i], st[i + 5]),
+                               _mm256_xor_si256(_mm256_xor_si256(st[i + 10], st[i + 15]), st[i + 20]));
+    }
+    for (int i = 0; i < 5; i++) {
+      __m256i t = _mm256_xor_si256(bc[(i + 4) % 5], ROTL4(bc[(i + 1) % 5], 1));
+      for (int j = 0; j < 25; j += 5) {
+        st[j + i] = _mm256_xor_si256(st[j + i], t);
+      }
+    }
+
+    KECCAK_RHO_PI(b, st, ROTL4);
+
+    for (int j = 0; j < 25; j += 5) {
+      for (int i = 0; i < 5; i++) {
+        st[j + i] = _mm256_xor_si256(b[j + i], _mm256_andnot_si256(b[j + (i + 1) % 5], b[j + (i + 2) % 5]));
+      }
+    }
+
+    st[0] = _mm256_xor_si256(st[0], _mm256_set1_epi64x((long long) keccak_rc[round]));
+  }
+}
+
+// Hash 4 messages at once, one per 64-bit lane (as sha256_x8).
+__attribute__((target("avx2")))
+static void keccak256_x4(const uint8_t *const *msgs, const size_t *lens, UInt256 *out) {
+  size_t numBlocks[4];
+  size_t maxBlocks = 0;
+  for (int lane = 0; lane < 4; lane++) {
+    numBlocks[lane] = keccak256_num_blocks(lens[lane]);
+    if (numBlocks[lane] > maxBlocks) {
+      maxBlocks = numBlocks[lane];
+    }
+  }
+
+  __m256i st[25];
+  for (int i = 0; i < 25; i++) {
+    st[i] = _mm256_setzero_si256();
+  }
+
+  uint8_t tmp[4][KECCAK256_RATE];
+  for (size_t j = 0; j < maxBlocks; j++) {
+    const uint8_t *blocks[4];
+    for (int lane = 0; lane < 4; lane++) {
+      blocks[lane] = j < numBlocks[lane] ? keccak256_block(msgs[lane], lens[lane], j, tmp[lane]) : tmp[lane];
+    }
+    for (int i = 0; i < KECCAK256_RATE / 8; i++) {
+      __m256i block = _mm256_setr_epi64x((long long) load_le64(blocks[0] + 8 * i), (long long) load_le64(blocks[1] + 8 * i),
+                                         (long long) load_le64(blocks[2] + 8 * i), (long long) load_le64(blocks[3] + 8 * i));
+      st[i] = _mm256_xor_si256(st[i], block);
+    }
+    keccak_f1600_x4(st);
+
+    for (int lane = 0; lane < 4; lane++) {
+      if (j + 1 == numBlocks[lane]) {
+        uint64_t lanes[4][4];
+        uint64_t digest[4];
+        for (int i = 0; i < 4; i++) {
+          _mm256_storeu_si256((__m256i *) lanes[i], st[i]);
+          digest[i] = lanes[i][lane];
+        }
+        out[lane] = keccak_to_uint256(digest);
+      }
+    }
+  }
+}
+
+#endif // UINT256_HASH_X86
+
+// Kernels available on this CPU, detected once
+#ifdef UINT256_HASH_X86
+static int hasShaNi;
+static int hasAvx2;
+#endif
+static pthread_once_t uint256_hash_once = PTHREAD_ONCE_INIT;
+
+static void uint256_detect_hash_kernels(void) {
+#ifdef UINT256_HASH_X86
+  unsigned eax, ebx, ecx, edx;
+  __builtin_cpu_init();
+  hasAvx2 = __builtin_cpu_supports("avx2");
+  hasShaNi = __builtin_cpu_supports("sse4.1") && __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) &&
+    (ebx & (1U << 29));
+#endif
+}
+
+// Compute the SHA-256 digest of the len bytes at data, as a UInt256.
+UInt256 uint256_from_sha256(const void *data, size_t len) {
+  pthread_once(&uint256_hash_once, uint256_detect_hash_kernels);
+  uint32_t state[8];
+  memcpy(state, sha256_init, sizeof(state));
+  uint8_t tmp[SHA256_BLOCK];
+  size_t numBlocks = sha256_num_blocks(len);
+  for (size_t j = 0; j < numBlocks; j++) {
+    const uint8_t *block = sha256_block(data, len, j, tmp);
+#ifdef UINT256_HASH_X86
+    if (hasShaNi) {
+      sha256_compress_shani(state, block);
+      continue;
+    }
+#endif
+    sha256_compress(state, block);
+  }
+  return sha256_to_uint256(state);
+}
+
+// Compute the Keccak-256 digest (the original Keccak padding, as used
+// by Ethereum, not the SHA3-256 padding) of the len bytes at data, as
+// a UInt256.
+UInt256 uint256_from_keccak256(const void *data, size_t len) {
+  uint64_t st[25] = { 0U };
+  uint8_t tmp[KECCAK256_RATE];
+  size_t numBlocks = keccak256_num_blocks(len);
+  for (size_t j = 0; j < numBlocks; j++) {
+    const uint8_t *block = keccak256_block(data, len, j, tmp);
+    for (int i = 0; i < KECCAK256_RATE / 8; i++) {
+      st[i] ^= load_le64(block + 8 * i);
+    }
+    keccak_f1600(st);
+  }
+  return keccak_to_uint256(st);
+}
+
+// Compute the SHA-256 digests of n messages (data[i] holding lens[i]
+// bytes) into out. Uses the SHA extensions if the CPU has them, and
+// otherwise hashes 8 messages at a time with AVX2 where available.
+void uint256_from_sha256_batch(const void *const *data, const size_t *lens, size_t n, UInt256 *out) {
+  pthread_once(&uint256_hash_once, uint256_detect_hash_kernels);
+  size_t i = 0;
+#ifdef UINT256_HASH_X86
+  if (!hasShaNi && hasAvx2) {
+    for (; i + 8 <= n; i += 8) {
+      sha256_x8((const uint8_t *const *) data + i, lens + i, out + i);
+    }
+  }
+#endif
+  for (; i < n; i++) {
+    out[i] = uint256_from_sha256(data[i], lens[i]);
+  }
+}
+
+// Compute the Keccak-256 digests of n messages (data[i] holding lens[i]
+// bytes) into out, hashing 4 messages at a time with AVX2 where
+// available.
+void uint256_from_keccak256_batch(const void *const *data, const size_t *lens, size_t n, UInt256 *out) {
+  pthread_once(&uint256_hash_once, uint256_detect_hash_kernels);
+  size_t i = 0;
+#ifdef UINT256_HASH_X86
+  if (hasAvx2) {
+    for (; i + 4 <= n; i += 4) {
+      keccak256_x4((const uint8_t *const *) data + i, lens + i, out + i);
+    }
+  }
+#endif
+  for (; i < n; i++) {
+    out[i] = uint256_from_keccak256(data[i], lens[i]);
+  }
+}
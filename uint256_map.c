@@ -0,0 +1,353 @@
+#include <stdlib.h>
+#include <string.h>
+#include "uint256.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Open-addressing hash table keyed by UInt256, laid out like a Swiss
+// table: a control byte per slot holds 7 bits of the key's hash (or
+// marks the slot empty/deleted), and lookups compare a whole group of
+// 16 control bytes against the hash at once before touching any keys.
+// Keys (and values, for a map) are stored inline in flat arrays.
+//
+// The control array has GROUP_WIDTH extra bytes at the end mirroring
+// the first GROUP_WIDTH slots, so a group can be loaded starting at
+// any slot without wrapping.
+
+#define GROUP_WIDTH 16
+#define MIN_CAPACITY 16
+
+#define CTRL_EMPTY ((uint8_t) 0x80)
+#define CTRL_DELETED ((uint8_t) 0xfe)
+
+// Number of keys ahead that uint256_map_get_batch prefetches
+#define PREFETCH_DISTANCE 8
+
+// Compute a 64-bit hash of a key. The low 7 bits become the control
+// byte and the rest select the starting slot.
+static uint64_t map_hash(const UInt256 *key) {
+  uint64_t h = 0x243f6a8885a308d3U;
+  for (int i = 0; i < 8; i += 2) {
+    uint64_t word = ((uint64_t) key->data[i + 1] << 32) | key->data[i];
+    h = (h ^ word) * 0x9e3779b97f4a7c15U;
+    h ^= h >> 32;
+  }
+  return h;
+}
+
+static uint8_t map_h2(uint64_t hash) {
+  return (uint8_t) (hash & 0x7f);
+}
+
+static size_t map_h1(uint64_t hash) {
+  return (size_t) (hash >> 7);
+}
+
+static int map_key_equal(const UInt256 *a, const UInt256 *b) {
+  return memcmp(a->data, b->data, sizeof(a->data)) == 0;
+}
+
+// Return a bitmask with bit i set if control byte i of the group
+// starting at ctrl equals h2.
+static uint32_t group_match(const uint8_t *ctrl, uint8_t h2) {
+#ifdef __SSE2__
+  __m128i group = _mm_loadu_si128((const __m128i *) ctrl);
+  return (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char) h2)));
+#else
+  uint32_t mask = 0U;
+  for (int i = 0; i < GROUP_WIDTH; i++) {
+    mask |= (uint32_t) (ctrl[i] == h2) << i;
+  }
+  return mask;
+#endif
+}
+
+// Return a bitmask of the empty slots in a group.
+static uint32_t group_match_empty(const uint8_t *ctrl) {
+  return group_match(ctrl, CTRL_EMPTY);
+}
+
+// Return a bitmask of the empty or deleted slots in a group (the
+// control bytes with their top bit set).
+static uint32_t group_match_empty_or_deleted(const uint8_t *ctrl) {
+#ifdef __SSE2__
+  return (uint32_t) _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) ctrl));
+#else
+  uint32_t mask = 0U;
+  for (int i = 0; i < GROUP_WIDTH; i++) {
+    mask |= (uint32_t) (ctrl[i] >> 7) << i;
+  }
+  return mask;
+#endif
+}
+
+static void map_set_ctrl(UInt256Map *map, size_t slot, uint8_t ctrl) {
+  map->ctrl[slot] = ctrl;
+  if (slot < GROUP_WIDTH) {
+    map->ctrl[map->capacity + slot] = ctrl;  //keep the mirror in sync
+  }
+}
+
+// Return the slot holding key, or -1 if it isn't in the table.
+static long map_find(const UInt256Map *map, const UInt256 *key, uint64_t hash) {
+  size_t mask = map->capacity - 1;
+  size_t pos = map_h1(hash) & mask;
+  uint8_t h2 = map_h2(hash);
+  // probe group by group with a growing stride, which visits
+  // every group when the capacity is a power of two
+  for (size_t stride = GROUP_WIDTH; ; stride += GROUP_WIDTH) {
+    const uint8_t *group = map->ctrl + pos;
+    for (uint32_t match = group_match(group, h2); match != 0; match &= match - 1) {
+      size_t slot = (pos + __builtin_ctz(match)) & mask;
+      if (map_key_equal(&map->keys[slot], key)) {
+        return (long) slot;
+      }
+    }
+    if (group_match_empty(group) != 0) {
+      return -1;  //the key would have been placed before this empty slot
+    }
+    pos = (pos + stride) & mask;
+  }
+}
+
+// Return the first empty or deleted slot along key's probe sequence.
+static size_t map_find_free(const UInt256Map *map, uint64_t hash) {
+  size_t mask = map->capacity - 1;
+  size_t pos = map_h1(hash) & mask;
+  for (size_t stride = GROUP_WIDTH; ; stride += GROUP_WIDTH) {
+    uint32_t match = group_match_empty_or_deleted(map->ctrl + pos);
+    if (match != 0) {
+      return (pos + __builtin_ctz(match)) & mask;
+    }
+    pos = (pos + stride) & mask;
+  }
+}
+
+// Allocate empty arrays for the given capacity (a power of two).
+static int map_alloc(UInt256Map *map, size_t capacity, int hasValues) {
+  map->ctrl = malloc(capacity + GROUP_WIDTH);
+  map->keys = malloc(capacity * sizeof(UInt256));
+  map->values = hasValues ? malloc(capacity * sizeof(uint64_t)) : NULL;
+  if (map->ctrl == NULL || map->keys == NULL || (hasValues && map->values == NULL)) {
+    free(map->ctrl);
+    free(map->keys);
+    free(map->values);
+    return 0;
+  }
+  memset(map->ctrl, CTRL_EMPTY, capacity + GROUP_WIDTH);
+  map->capacity = capacity;
+  map->size = 0;
+  map->growthLeft = capacity - capacity / 8;  // max load factor 7/8
+  return 1;
+}
+
+// Move every entry into freshly allocated arrays of the given capacity.
+// Also clears out deleted slots.
+static int map_rehash(UInt256Map *map, size_t capacity) {
+  UInt256Map old = *map;
+  if (!map_alloc(map, capacity, old.values != NULL)) {
+    *map = old;
+    return 0;
+  }
+  for (size_t slot = 0; slot < old.capacity; slot++) {
+    if (old.ctrl[slot] & 0x80) {
+      continue;  //empty or deleted
+    }
+    uint64_t hash = map_hash(&old.keys[slot]);
+    size_t dest = map_find_free(map, hash);
+    map_set_ctrl(map, dest, map_h2(hash));
+    map->keys[dest] = old.keys[slot];
+    if (map->values) {
+      map->values[dest] = old.values[slot];
+    }
+  }
+  map->size = old.size;
+  map->growthLeft -= old.size;
+  free(old.ctrl);
+  free(old.keys);
+  free(old.values);
+  return 1;
+}
+
+static int map_init(UInt256Map *map, size_t expected, int hasValues) {
+  // smallest power of two that holds expected keys at 7/8 load
+  size_t capacity = MIN_CAPACITY;
+  while (capacity - capacity / 8 < expected) {
+    capacity *= 2;
+  }
+  return map_alloc(map, capacity, hasValues);
+}
+
+// Insert key if it isn't present. Returns 1 if it was inserted, 0 if
+// it was already present, -1 if memory ran out. *slotOut is set to
+// the key's slot in either of the first two cases.
+static int map_insert(UInt256Map *map, const UInt256 *key, size_t *slotOut) {
+  uint64_t hash = map_hash(key);
+  long found = map_find(map, key, hash);
+  if (found >= 0) {
+    *slotOut = (size_t) found;
+    return 0;
+  }
+
+  size_t slot = map_find_free(map, hash);
+  if (map->growthLeft == 0 && map->ctrl[slot] == CTRL_EMPTY) {
+    // grow if the table is mostly live entries, otherwise just
+    // rehash in place to reclaim deleted slots
+    size_t capacity = map->size * 2 >= map->capacity - map->capacity / 8 ? map->capacity * 2 : map->capacity;
+    if (!map_rehash(map, capacity)) {
+      return -1;
+    }
+    slot = map_find_free(map, hash);
+  }
+
+  if (map->ctrl[slot] == CTRL_EMPTY) {
+    map->growthLeft--;  //reusing a deleted slot doesn't use up an empty one
+  }
+  map_set_ctrl(map, slot, map_h2(hash));
+  map->keys[slot] = *key;
+  map->size++;
+  *slotOut = slot;
+  return 1;
+}
+
+static int map_remove(UInt256Map *map, const UInt256 *key) {
+  long found = map_find(map, key, map_hash(key));
+  if (found < 0) {
+    return 0;
+  }
+  map_set_ctrl(map, (size_t) found, CTRL_DELETED);
+  map->size--;
+  return 1;
+}
+
+// Look up n keys, prefetching the control bytes and keys for the
+// lookup PREFETCH_DISTANCE ahead so their cache misses overlap.
+// Stores whether each key was found in found[i] and (if values is
+// not NULL) its value in values[i].
+static void map_find_batch(const UInt256Map *map, const UInt256 *keys, size_t n,
+                           uint64_t *values, unsigned char *found) {
+  size_t mask = map->capacity - 1;
+  uint64_t hashes[PREFETCH_DISTANCE];
+  for (size_t i = 0; i < n && i < PREFETCH_DISTANCE; i++) {
+    hashes[i] = map_hash(&keys[i]);
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    uint64_t hash = hashes[i % PREFETCH_DISTANCE];
+    if (i + PREFETCH_DISTANCE < n) {
+      uint64_t ahead = map_hash(&keys[i + PREFETCH_DISTANCE]);
+      size_t pos = map_h1(ahead) & mask;
+      __builtin_prefetch(map->ctrl + pos);
+      __builtin_prefetch(&map->keys[pos]);
+      hashes[i % PREFETCH_DISTANCE] = ahead;
+    }
+
+    long slot = map_find(map, &keys[i], hash);
+    found[i] = slot >= 0;
+    if (values && slot >= 0) {
+      values[i] = map->values[slot];
+    }
+  }
+}
+
+// Create an empty map with room for at least expected keys before
+// it needs to grow. Returns 1 on success, 0 if memory ran out.
+int uint256_map_init(UInt256Map *map, size_t expected) {
+  return map_init(map, expected, 1);
+}
+
+// Free the memory used by a map.
+void uint256_map_destroy(UInt256Map *map) {
+  free(map->ctrl);
+  free(map->keys);
+  free(map->values);
+  map->ctrl = NULL;
+  map->keys = NULL;
+  map->values = NULL;
+  map->capacity = map->size = map->growthLeft = 0;
+}
+
+// Associate value with key, replacing any existing value. Returns 1
+// if the key was added, 0 if it was already present, and -1 if memory
+// ran out (in which case the map is unchanged).
+int uint256_map_put(UInt256Map *map, UInt256 key, uint64_t value) {
+  size_t slot;
+  int result = map_insert(map, &key, &slot);
+  if (result >= 0) {
+    map->values[slot] = value;
+  }
+  return result;
+}
+
+// Look up key. Returns 1 and stores its value in *value (if value is
+// not NULL) if the key is present, otherwise returns 0.
+int uint256_map_get(const UInt256Map *map, UInt256 key, uint64_t *value) {
+  long slot = map_find(map, &key, map_hash(&key));
+  if (slot < 0) {
+    return 0;
+  }
+  if (value) {
+    *value = map->values[slot];
+  }
+  return 1;
+}
+
+// Look up n keys at once, overlapping their memory accesses. For each
+// i, found[i] is set to 1 if keys[i] is present (and its value stored
+// in values[i]) or 0 if not (and values[i] is left unchanged).
+void uint256_map_get_batch(const UInt256Map *map, const UInt256 *keys, size_t n,
+                           uint64_t *values, unsigned char *found) {
+  map_find_batch(map, keys, n, values, found);
+}
+
+// Remove key from the map. Returns 1 if it was present, 0 otherwise.
+int uint256_map_remove(UInt256Map *map, UInt256 key) {
+  return map_remove(map, &key);
+}
+
+// Return the number of keys in the map.
+size_t uint256_map_size(const UInt256Map *map) {
+  return map->size;
+}
+
+// Create an empty set with room for at least expected keys before
+// it needs to grow. Returns 1 on success, 0 if memory ran out.
+int uint256_set_init(UInt256Set *set, size_t expected) {
+  return map_init(&set->table, expected, 0);
+}
+
+// Free the memory used by a set.
+void uint256_set_destroy(UInt256Set *set) {
+  uint256_map_destroy(&set->table);
+}
+
+// Add key to the set. Returns 1 if it was added, 0 if it was already
+// present, and -1 if memory ran out (in which case the set is unchanged).
+int uint256_set_add(UInt256Set *set, UInt256 key) {
+  size_t slot;
+  return map_insert(&set->table, &key, &slot);
+}
+
+// Return 1 if key is in the set, 0 otherwise.
+int uint256_set_contains(const UInt256Set *set, UInt256 key) {
+  return map_find(&set->table, &key, map_hash(&key)) >= 0;
+}
+
+// Check n keys at once, overlapping their memory accesses. found[i]
+// is set to 1 if keys[i] is in the set, 0 otherwise.
+void uint256_set_contains_batch(const UInt256Set *set, const UInt256 *keys, size_t n,
+                                unsigned char *found) {
+  map_find_batch(&set->table, keys, n, NULL, found);
+}
+
+// Remove key from the set. Returns 1 if it was present, 0 otherwise.
+int uint256_set_remove(UInt256Set *set, UInt256 key) {
+  return map_remove(&set->table, &key);
+}
+
+// Return the number of keys in the set.
+size_t uint256_set_size(const UInt256Set *set) {
+  return set->table.size;
+}
@@ -0,0 +1,109 @@
+#include "uint256.h"
+
+// Pseudo-random UInt256 generation with xoshiro256** (Blackman and
+// Vigna). It is fast and statistically strong, but NOT suitable for
+// secrets: use a cryptographic generator for keys and nonces.
+
+static uint64_t rotl64(uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+// Return the next 64 bits from the generator.
+static uint64_t xoshiro_next(UInt256Rng *rng) {
+  uint64_t *s = rng->s;
+  uint64_t result = rotl64(s[1] * 5, 7) * 9;
+  uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotl64(s[3], 45);
+  return result;
+}
+
+// Seed a generator. The same seed always produces the same sequence.
+void uint256_rng_seed(UInt256Rng *rng, uint64_t seed) {
+  // expand the seed with splitmix64, as recommended for xoshiro (this
+  // never produces the all-zero state)
+  for (int i = 0; i < 4; i++) {
+    uint64_t z = (seed += 0x9e3779b97f4a7c15U);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9U;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebU;
+    rng->s[i] = z ^ (z >> 31);
+  }
+}
+
+// Advance a generator by 2^128 steps. Seeding one generator and
+// jumping it once per thread gives each thread its own reproducible,
+// non-overlapping stream.
+void uint256_rng_jump(UInt256Rng *rng) {
+  static const uint64_t jump[4] = {
+    0x180ec6d33cfd0abaU, 0xd5a61266f0c9392cU, 0xa9582618e03fc9aaU, 0x39abdc4529b1661cU
+  };
+  uint64_t s[4] = { 0U, 0U, 0U, 0U };
+  for (int i = 0; i < 4; i++) {
+    for (int b = 0; b < 64; b++) {
+      if (jump[i] & (1ULL << b)) {
+        for (int k = 0; k < 4; k++) {
+          s[k] ^= rng->s[k];
+        }
+      }
+      xoshiro_next(rng);
+    }
+  }
+  for (int k = 0; k < 4; k++) {
+    rng->s[k] = s[k];
+  }
+}
+
+// Return a uniformly random UInt256 value.
+UInt256 uint256_random(UInt256Rng *rng) {
+  UInt256 result;
+  for (int i = 0; i < 8; i += 2) {
+    uint64_t bits = xoshiro_next(rng);
+    result.data[i] = (uint32_t) bits;
+    result.data[i + 1] = (uint32_t) (bits >> 32);
+  }
+  return result;
+}
+
+// Fill out with n uniformly random values (the same values n calls
+// to uint256_random would return).
+void uint256_random_fill(UInt256Rng *rng, UInt256 *out, size_t n) {
+  // keep the state in locals so it stays in registers
+  UInt256Rng local = *rng;
+  for (size_t j = 0; j < n; j++) {
+    for (int i = 0; i < 8; i += 2) {
+      uint64_t bits = xoshiro_next(&local);
+      out[j].data[i] = (uint32_t) bits;
+      out[j].data[i + 1] = (uint32_t) (bits >> 32);
+    }
+  }
+  *rng = local;
+}
+
+// Return a uniformly random value less than bound, or a uniformly
+// random value of any size if bound is 0.
+UInt256 uint256_random_below(UInt256Rng *rng, UInt256 bound) {
+  if (uint256_is_zero(bound)) {
+    return uint256_random(rng);
+  }
+  // draw values with as many bits as bound-1 and reject those that are
+  // too large; each draw is accepted with probability more than 1/2
+  unsigned bits = uint256_bit_length(uint256_sub(bound, uint256_create_from_u32(1U)));
+  for (;;) {
+    UInt256 candidate = uint256_random(rng);
+    for (int i = 0; i < 8; i++) {
+      int limbBits = (int) bits - 32 * i;
+      if (limbBits <= 0) {
+        candidate.data[i] = 0U;
+      } else if (limbBits < 32) {
+        candidate.data[i] &= (1U << limbBits) - 1;
+      }
+    }
+    if (uint256_compare(candidate, bound) < 0) {
+      return candidate;
+    }
+  }
+}
@@ -0,0 +1,211 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "uint256.h"
+#include "uint256_stats.h"
+
+#ifdef UINT256_STATS
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+// Only every UINT256_STATS_SAMPLE_INTERVAL-th call of each operation
+// is timed, so the timestamp reads stay off most calls
+#define UINT256_STATS_SAMPLE_INTERVAL 64
+
+// Latencies are bucketed by floor(log2(cycles))
+#define UINT256_STATS_BUCKETS 32
+
+static const char *uint256_op_names[UINT256_OP_COUNT] = {
+  "create_from_hex",
+  "format_as_hex",
+  "format_as_decimal",
+  "mul",
+  "muladd",
+  "dot_n",
+  "accumulator_add_n",
+  "divmod",
+};
+
+typedef struct {
+  uint64_t calls;
+  uint64_t bytesAllocated;
+  uint64_t histogram[UINT256_STATS_BUCKETS];
+} OpStats;
+
+// Counters for one thread. Only the owning thread writes them (with
+// plain relaxed loads and stores, so the hooks take no locked
+// instructions); the dump only reads them. uint256_stats_reset instead
+// bumps resetEpoch, and the owner zeroes its counters the next time it
+// sees resetEpoch differ from seenEpoch. The blocks are 64-byte
+// aligned and padded, so each thread's counters stay in their own
+// cache lines, and are linked into a global list (with a lock-free
+// push) so the dump can find them.
+typedef struct ThreadStats {
+  OpStats ops[UINT256_OP_COUNT];
+  uint64_t resetEpoch;
+  uint64_t seenEpoch;
+  struct ThreadStats *next;
+} ThreadStats;
+
+#define UINT256_STATS_ALIGN 64
+
+static ThreadStats *uint256_stats_head;
+static _Thread_local ThreadStats *uint256_stats_mine;
+
+// Zero the calling thread's counters if a reset happened since it last
+// looked.
+static void uint256_stats_catch_up(ThreadStats *stats) {
+  uint64_t epoch = __atomic_load_n(&stats->resetEpoch, __ATOMIC_RELAXED);
+  if (epoch == stats->seenEpoch) {
+    return;
+  }
+  for (int op = 0; op < UINT256_OP_COUNT; op++) {
+    __atomic_store_n(&stats->ops[op].calls, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&stats->ops[op].bytesAllocated, 0, __ATOMIC_RELAXED);
+    for (int b = 0; b < UINT256_STATS_BUCKETS; b++) {
+      __atomic_store_n(&stats->ops[op].histogram[b], 0, __ATOMIC_RELAXED);
+    }
+  }
+  // release, so a dump that sees the new epoch also sees the zeroes
+  __atomic_store_n(&stats->seenEpoch, epoch, __ATOMIC_RELEASE);
+}
+
+static ThreadStats *uint256_stats_thread(void) {
+  ThreadStats *stats = uint256_stats_mine;
+  if (stats == NULL) {
+    // never freed, so the dump can still read a finished thread's counts
+    size_t size = (sizeof(ThreadStats) + UINT256_STATS_ALIGN - 1) / UINT256_STATS_ALIGN * UINT256_STATS_ALIGN;
+    stats = aligned_alloc(UINT256_STATS_ALIGN, size);
+    if (stats == NULL) {
+      abort();
+    }
+    memset(stats, 0, size);
+    stats->next = __atomic_load_n(&uint256_stats_head, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&uint256_stats_head, &stats->next, stats, 1,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+      // stats->next was reloaded with the current head, try again
+    }
+    uint256_stats_mine = stats;
+  }
+  uint256_stats_catch_up(stats);
+  return stats;
+}
+
+// Add amount to one of the calling thread's counters, returning its
+// new value. Only the owner writes the counter, so a relaxed load and
+// store suffice; the atomics only keep the dump's reads well-defined.
+static uint64_t uint256_stats_bump(uint64_t *counter, uint64_t amount) {
+  uint64_t value = __atomic_load_n(counter, __ATOMIC_RELAXED) + amount;
+  __atomic_store_n(counter, value, __ATOMIC_RELAXED);
+  return value;
+}
+
+static uint64_t uint256_stats_timestamp(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000U + ts.tv_nsec;
+#endif
+}
+
+// Record a call to op. Returns a start timestamp if this call's
+// latency should be sampled, 0 otherwise.
+uint64_t uint256_stats_begin(UInt256Op op) {
+  OpStats *stats = &uint256_stats_thread()->ops[op];
+  if (uint256_stats_bump(&stats->calls, 1) % UINT256_STATS_SAMPLE_INTERVAL != 1) {
+    return 0;
+  }
+  return uint256_stats_timestamp();
+}
+
+// Record the latency of a sampled call (does nothing if start is 0).
+void uint256_stats_end(UInt256Op op, uint64_t start) {
+  if (start == 0) {
+    return;
+  }
+  uint64_t elapsed = uint256_stats_timestamp() - start;
+  unsigned bucket = elapsed == 0 ? 0 : 63 - __builtin_clzll(elapsed);
+  if (bucket >= UINT256_STATS_BUCKETS) {
+    bucket = UINT256_STATS_BUCKETS - 1;
+  }
+  uint256_stats_bump(&uint256_stats_thread()->ops[op].histogram[bucket], 1);
+}
+
+// Record that op allocated the given number of bytes.
+void uint256_stats_alloc(UInt256Op op, size_t bytes) {
+  uint256_stats_bump(&uint256_stats_thread()->ops[op].bytesAllocated, bytes);
+}
+
+// Return a dynamically-allocated JSON string describing the counters
+// summed over every thread that has called an instrumented function.
+char *uint256_stats_dump(void) {
+  OpStats totals[UINT256_OP_COUNT];
+  memset(totals, 0, sizeof(totals));
+  for (ThreadStats *t = __atomic_load_n(&uint256_stats_head, __ATOMIC_ACQUIRE); t != NULL; t = t->next) {
+    // a thread that has not caught up with a reset has nothing to count
+    if (__atomic_load_n(&t->seenEpoch, __ATOMIC_ACQUIRE) != __atomic_load_n(&t->resetEpoch, __ATOMIC_RELAXED)) {
+      continue;
+    }
+    for (int op = 0; op < UINT256_OP_COUNT; op++) {
+      totals[op].calls += __atomic_load_n(&t->ops[op].calls, __ATOMIC_RELAXED);
+      totals[op].bytesAllocated += __atomic_load_n(&t->ops[op].bytesAllocated, __ATOMIC_RELAXED);
+      for (int b = 0; b < UINT256_STATS_BUCKETS; b++) {
+        totals[op].histogram[b] += __atomic_load_n(&t->ops[op].histogram[b], __ATOMIC_RELAXED);
+      }
+    }
+  }
+
+  char *json = NULL;
+  size_t size = 0;
+  FILE *out = open_memstream(&json, &size);
+  if (out == NULL) {
+    return NULL;
+  }
+  fprintf(out, "{\"enabled\":true,\"sample_interval\":%d,\"ops\":{", UINT256_STATS_SAMPLE_INTERVAL);
+  for (int op = 0; op < UINT256_OP_COUNT; op++) {
+    fprintf(out, "%s\"%s\":{\"calls\":%llu,\"bytes_allocated\":%llu,\"latency_log2_cycles\":[",
+            op == 0 ? "" : ",", uint256_op_names[op],
+            (unsigned long long) totals[op].calls,
+            (unsigned long long) totals[op].bytesAllocated);
+    for (int b = 0; b < UINT256_STATS_BUCKETS; b++) {
+      fprintf(out, "%s%llu", b == 0 ? "" : ",", (unsigned long long) totals[op].histogram[b]);
+    }
+    fprintf(out, "]}");
+  }
+  fprintf(out, "}}");
+  fclose(out);
+  return json;
+}
+
+// Reset every thread's counters to zero. Each thread zeroes its own
+// counters on its next instrumented call, and the dump skips threads
+// that have not done so yet. Calls running concurrently on other
+// threads may or may not be counted.
+void uint256_stats_reset(void) {
+  for (ThreadStats *t = __atomic_load_n(&uint256_stats_head, __ATOMIC_ACQUIRE); t != NULL; t = t->next) {
+    __atomic_add_fetch(&t->resetEpoch, 1, __ATOMIC_RELAXED);
+  }
+}
+
+#else
+
+// Return a dynamically-allocated JSON string describing the counters.
+// Statistics were not compiled in, so there are none to report.
+char *uint256_stats_dump(void) {
+  const char *json = "{\"enabled\":false}";
+  char *result = malloc(strlen(json) + 1);
+  strcpy(result, json);
+  return result;
+}
+
+// Reset every thread's counters to zero (nothing to do in this build).
+void uint256_stats_reset(void) {
+}
+
+#endif // UINT256_STATS
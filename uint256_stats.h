@@ -0,0 +1,49 @@
+#ifndef UINT256_STATS_H
+#define UINT256_STATS_H
+
+// Internal instrumentation hooks for uint256.c. When the library is
+// built with -DUINT256_STATS, each hooked function counts its calls
+// and allocations and samples its latency (in cycles) into per-thread
+// counters. Without the flag, every hook expands to nothing.
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Operations that are instrumented
+typedef enum {
+  UINT256_OP_CREATE_FROM_HEX,
+  UINT256_OP_FORMAT_AS_HEX,
+  UINT256_OP_FORMAT_AS_DECIMAL,
+  UINT256_OP_MUL,
+  UINT256_OP_MULADD,
+  UINT256_OP_DOT_N,
+  UINT256_OP_ACCUMULATOR_ADD_N,
+  UINT256_OP_DIVMOD,
+  UINT256_OP_COUNT
+} UInt256Op;
+
+#ifdef UINT256_STATS
+
+// Record a call to op. Returns a start timestamp if this call's
+// latency should be sampled, 0 otherwise.
+uint64_t uint256_stats_begin(UInt256Op op);
+
+// Record the latency of a sampled call (does nothing if start is 0).
+void uint256_stats_end(UInt256Op op, uint64_t start);
+
+// Record that op allocated the given number of bytes.
+void uint256_stats_alloc(UInt256Op op, size_t bytes);
+
+#define UINT256_STATS_BEGIN(op) uint64_t uint256StatsStart = uint256_stats_begin(op)
+#define UINT256_STATS_END(op) uint256_stats_end(op, uint256StatsStart)
+#define UINT256_STATS_ALLOC(op, bytes) uint256_stats_alloc(op, bytes)
+
+#else
+
+#define UINT256_STATS_BEGIN(op) do { } while (0)
+#define UINT256_STATS_END(op) do { } while (0)
+#define UINT256_STATS_ALLOC(op, bytes) do { } while (0)
+
+#endif // UINT256_STATS
+
+#endif // UINT256_STATS_H
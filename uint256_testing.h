@@ -0,0 +1,16 @@
+#ifndef UINT256_TESTING_H
+#define UINT256_TESTING_H
+
+// Test-only hooks into uint256.c. These are not part of the public
+// API in uint256.h, and are hidden from libuint256.so; they let the
+// tests (which link the objects directly) exercise code paths that
+// otherwise depend on the machine they run on.
+
+#define UINT256_TESTING_HOOK __attribute__((visibility("hidden")))
+
+// Set the number of threads that large dot products, sums, prefix sums
+// and min/max scans are split across (at most 16). 0 restores the
+// default of one thread per processor.
+UINT256_TESTING_HOOK void uint256_set_num_threads(unsigned numThreads);
+
+#endif // UINT256_TESTING_H
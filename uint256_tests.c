@@ -1,8 +1,10 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
 #include "tctest.h"
 
 #include "uint256.h"
+#include "uint256_testing.h"
 
 typedef struct {
   UInt256 zero; // the value equal to 0
@@ -15,6 +17,10 @@ typedef struct {
 
 // Helper functions for implementing tests
 void set_all(UInt256 *val, uint32_t wordval);
+static void print_test_time(const char *testname, int passed);
+static size_t column_round_trip(const UInt256 *vals, size_t n);
+static void count_job(void *arg);
+static void square_range(void *ctx, size_t begin, size_t end);
 
 #define ASSERT_SAME(expected, actual) \
 do { \
@@ -44,18 +50,77 @@ void test_create_from_u32(TestObjs *objs);
 void test_create(TestObjs *objs);
 void test_create_from_hex(TestObjs *objs);
 void test_format_as_hex(TestObjs *objs);
+void test_format_as_decimal(TestObjs *objs);
+void test_bit_scan(TestObjs *objs);
+void test_popcount(TestObjs *objs);
+void test_test_and_set_bit(TestObjs *objs);
 void test_add(TestObjs *objs);
 void test_add_genfact();
 void test_add_genfact2();
 void test_sub(TestObjs *objs);
 void test_subtract_genfact();
 void test_negate(TestObjs *objs);
+void test_mul(TestObjs *objs);
+void test_muladd(TestObjs *objs);
+void test_dot_n(TestObjs *objs);
+void test_accumulator(TestObjs *objs);
+void test_compare(TestObjs *objs);
+void test_shift(TestObjs *objs);
+void test_divmod(TestObjs *objs);
+void test_isqrt(TestObjs *objs);
+void test_gcd(TestObjs *objs);
+void test_pow(TestObjs *objs);
+void test_signed_compare(TestObjs *objs);
+void test_signed_shift_right(TestObjs *objs);
+void test_signed_divmod(TestObjs *objs);
+void test_signed_format_as_decimal(TestObjs *objs);
 void test_rotate_left(TestObjs *objs);
 void test_rotate_right(TestObjs *objs);
-
+void test_stats(TestObjs *objs);
+void test_ct_compare_select(TestObjs *objs);
+void test_ct_add_sub(TestObjs *objs);
+void test_ct_mod(TestObjs *objs);
+void test_ct_rotate_left(TestObjs *objs);
+void test_ct_create_from_hex(TestObjs *objs);
+void test_mulmod(TestObjs *objs);
+void test_mod_pow(TestObjs *objs);
+void test_mod_inv(TestObjs *objs);
+void test_mod_inv_batch(TestObjs *objs);
+void test_mod_multiexp(TestObjs *objs);
+void test_map(TestObjs *objs);
+void test_map_grow_and_remove(TestObjs *objs);
+void test_set(TestObjs *objs);
+void test_column_round_trip(TestObjs *objs);
+void test_column_file(TestObjs *objs);
+void test_sum_and_prefix_sum(TestObjs *objs);
+void test_min_max(TestObjs *objs);
+void test_random(TestObjs *objs);
+void test_random_below(TestObjs *objs);
+void test_to_double(TestObjs *objs);
+void test_from_double(TestObjs *objs);
+void test_scale_pow10(TestObjs *objs);
+void test_from_sha256(TestObjs *objs);
+void test_from_keccak256(TestObjs *objs);
+void test_executor_jobs(TestObjs *objs);
+void test_executor_concurrent_jobs(TestObjs *objs);
+
+// Usage: uint256_tests [-j num_workers] [-t] [testname]
+//   -j runs tests in parallel in forked worker processes
+//   -t prints the wall-clock time of each test
 int main(int argc, char **argv) {
-  if (argc > 1) {
-    tctest_testname_to_execute = argv[1];
+  int opt;
+  while ((opt = getopt(argc, argv, "j:t")) != -1) {
+    if (opt == 'j') {
+      tctest_num_workers = atoi(optarg);
+    } else if (opt == 't') {
+      tctest_on_test_executed = print_test_time;
+    } else {
+      fprintf(stderr, "Usage: %s [-j num_workers] [-t] [testname]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (optind < argc) {
+    tctest_testname_to_execute = argv[optind];
   }
 
   TEST_INIT();
@@ -65,14 +130,59 @@ int main(int argc, char **argv) {
   TEST(test_create);
   TEST(test_create_from_hex);
   TEST(test_format_as_hex);
+  TEST(test_format_as_decimal);
+  TEST(test_bit_scan);
+  TEST(test_popcount);
+  TEST(test_test_and_set_bit);
   TEST(test_add);
   TEST(test_add_genfact);
   TEST(test_add_genfact2);
   TEST(test_sub);
   TEST(test_subtract_genfact);
   TEST(test_negate);
+  TEST(test_mul);
+  TEST(test_muladd);
+  TEST(test_dot_n);
+  TEST(test_accumulator);
+  TEST(test_compare);
+  TEST(test_shift);
+  TEST(test_divmod);
+  TEST(test_isqrt);
+  TEST(test_gcd);
+  TEST(test_pow);
+  TEST(test_signed_compare);
+  TEST(test_signed_shift_right);
+  TEST(test_signed_divmod);
+  TEST(test_signed_format_as_decimal);
   TEST(test_rotate_left);
   TEST(test_rotate_right);
+  TEST(test_stats);
+  TEST(test_ct_compare_select);
+  TEST(test_ct_add_sub);
+  TEST(test_ct_mod);
+  TEST(test_ct_rotate_left);
+  TEST(test_ct_create_from_hex);
+  TEST(test_mulmod);
+  TEST(test_mod_pow);
+  TEST(test_mod_inv);
+  TEST(test_mod_inv_batch);
+  TEST(test_mod_multiexp);
+  TEST(test_map);
+  TEST(test_map_grow_and_remove);
+  TEST(test_set);
+  TEST(test_column_round_trip);
+  TEST(test_column_file);
+  TEST(test_sum_and_prefix_sum);
+  TEST(test_min_max);
+  TEST(test_random);
+  TEST(test_random_below);
+  TEST(test_to_double);
+  TEST(test_from_double);
+  TEST(test_scale_pow10);
+  TEST(test_from_sha256);
+  TEST(test_from_keccak256);
+  TEST(test_executor_jobs);
+  TEST(test_executor_concurrent_jobs);
 
   TEST_FINI();
 }
@@ -84,6 +194,12 @@ void set_all(UInt256 *val, uint32_t wordval) {
   }
 }
 
+// Print how long each test took (enabled with -t)
+static void print_test_time(const char *testname, int passed) {
+  printf("  %s %s in %.3f ms\n", testname, passed ? "passed" : "failed",
+         tctest_last_test_seconds * 1000.0);
+}
+
 TestObjs *setup(void) {
   TestObjs *objs = (TestObjs *) malloc(sizeof(TestObjs));
 
@@ -110,6 +226,8 @@ TestObjs *setup(void) {
 }
 
 void cleanup(TestObjs *objs) {
+  // restore the default, even if a test failed while overriding it
+  uint256_set_num_threads(0);
   free(objs);
 }
 
@@ -217,6 +335,100 @@ void test_format_as_hex(TestObjs *objs) {
   free(s);
 }
 
+void test_format_as_decimal(TestObjs *objs) {
+  char *s;
+
+  s = uint256_format_as_decimal(objs->zero);
+  ASSERT(0 == strcmp("0", s));
+  free(s);
+
+  s = uint256_format_as_decimal(objs->one);
+  ASSERT(0 == strcmp("1", s));
+  free(s);
+
+  s = uint256_format_as_decimal(uint256_create_from_u32(1000000000U));  // exactly one 9-digit chunk boundary
+  ASSERT(0 == strcmp("1000000000", s));
+  free(s);
+
+  s = uint256_format_as_decimal(objs->max);
+  ASSERT(0 == strcmp("115792089237316195423570985008687907853269984665640564039457584007913129639935", s));
+  free(s);
+
+  s = uint256_format_as_decimal(objs->msb_set);
+  ASSERT(0 == strcmp("57896044618658097711785492504343953926634992332820282019728792003956564819968", s));
+  free(s);
+}
+
+void test_bit_scan(TestObjs *objs) {
+  ASSERT(256U == uint256_clz(objs->zero));
+  ASSERT(256U == uint256_ctz(objs->zero));
+  ASSERT(0U == uint256_bit_length(objs->zero));
+
+  ASSERT(255U == uint256_clz(objs->one));
+  ASSERT(0U == uint256_ctz(objs->one));
+  ASSERT(1U == uint256_bit_length(objs->one));
+
+  ASSERT(0U == uint256_clz(objs->msb_set));
+  ASSERT(255U == uint256_ctz(objs->msb_set));
+  ASSERT(256U == uint256_bit_length(objs->msb_set));
+
+  ASSERT(0U == uint256_clz(objs->max));
+  ASSERT(1U == uint256_ctz(objs->one_below_max));
+
+  // wild value: CD000000 ... 000000AB
+  ASSERT(0U == uint256_clz(objs->wild));
+  ASSERT(0U == uint256_ctz(objs->wild));
+
+  UInt256 val = uint256_rotate_right(objs->wild, 8);   // ABCD0000 00000000 ...
+  ASSERT(0U == uint256_clz(val));
+  ASSERT(240U == uint256_ctz(val));
+
+  val = uint256_rotate_left(objs->wild, 8);             // ... 00000000 0000ABCD
+  ASSERT(240U == uint256_clz(val));
+  ASSERT(16U == uint256_bit_length(val));
+  ASSERT(0U == uint256_ctz(val));
+}
+
+void test_popcount(TestObjs *objs) {
+  ASSERT(0U == uint256_popcount(objs->zero));
+  ASSERT(1U == uint256_popcount(objs->one));
+  ASSERT(256U == uint256_popcount(objs->max));
+  ASSERT(255U == uint256_popcount(objs->one_below_max));
+  ASSERT(10U == uint256_popcount(objs->wild));   // 0xCD has 5 bits set, 0xAB has 5
+
+  UInt256 vals[5] = { objs->zero, objs->one, objs->max, objs->one_below_max, objs->wild };
+  unsigned counts[5];
+  uint256_popcount_n(vals, 5, counts);
+  ASSERT(0U == counts[0]);
+  ASSERT(1U == counts[1]);
+  ASSERT(256U == counts[2]);
+  ASSERT(255U == counts[3]);
+  ASSERT(10U == counts[4]);
+}
+
+void test_test_and_set_bit(TestObjs *objs) {
+  UInt256 result;
+
+  ASSERT(1 == uint256_test_bit(objs->one, 0));
+  ASSERT(0 == uint256_test_bit(objs->one, 1));
+  ASSERT(1 == uint256_test_bit(objs->msb_set, 255));
+  ASSERT(0 == uint256_test_bit(objs->msb_set, 254));
+  ASSERT(1 == uint256_test_bit(objs->wild, 248));   // 0xCD = 11001101
+  ASSERT(0 == uint256_test_bit(objs->wild, 249));
+
+  result = uint256_set_bit(objs->zero, 0, 1);
+  ASSERT_SAME(objs->one, result);
+
+  result = uint256_set_bit(objs->zero, 255, 1);
+  ASSERT_SAME(objs->msb_set, result);
+
+  result = uint256_set_bit(objs->max, 0, 0);
+  ASSERT_SAME(objs->one_below_max, result);
+
+  result = uint256_set_bit(objs->one, 0, 1);        // setting a set bit changes nothing
+  ASSERT_SAME(objs->one, result);
+}
+
 void test_add(TestObjs *objs) {
   UInt256 result;
 
@@ -389,6 +601,421 @@ void test_negate(TestObjs *objs) {
   ASSERT_SAME(two, result);
 }
 
+void test_mul(TestObjs *objs) {
+  UInt256 result;
+
+  result = uint256_mul(objs->wild, objs->zero);   // x * 0
+  ASSERT_SAME(objs->zero, result);
+
+  result = uint256_mul(objs->wild, objs->one);    // x * 1
+  ASSERT_SAME(objs->wild, result);
+
+  result = uint256_mul(objs->max, objs->max);     // MAX * MAX = 1 (mod 2^256)
+  ASSERT_SAME(objs->one, result);
+
+  uint32_t two_data[8] = { 2U };
+  UInt256 two;
+  INIT_FROM_ARR(two, two_data);
+  result = uint256_mul(objs->msb_set, two);       // 2^255 * 2 = 0 (overflow)
+  ASSERT_SAME(objs->zero, result);
+
+  uint32_t left_data[8] = { 0x196e5c4dU, 0xca0a5ed3U, 0x8f30e466U, 0xc4af27c1U, 0x4b7fa5b0U, 0x84f6d706U, 0xb68e753eU, 0x4ed4d335U };
+  uint32_t right_data[8] = { 0xd099c673U, 0x7f0672b7U, 0xc0336d91U, 0x44fe4badU, 0x39e27f62U, 0x301b9dc4U, 0x1bc698a0U, 0xdedd27daU };
+  uint32_t product_data[8] = { 0x81fc0497U, 0xa8a0017eU, 0xaf8f7ae6U, 0xf32727dfU, 0x34636820U, 0x4500b50bU, 0x21c4e51eU, 0xa68f2040U };
+  UInt256 left, right, product;
+  INIT_FROM_ARR(left, left_data);
+  INIT_FROM_ARR(right, right_data);
+  INIT_FROM_ARR(product, product_data);
+  result = uint256_mul(left, right);
+  ASSERT_SAME(product, result);
+}
+
+void test_muladd(TestObjs *objs) {
+  UInt256 result, carry;
+
+  result = uint256_muladd(objs->max, objs->max, objs->max, &carry);  // MAX*MAX + MAX = MAX * 2^256
+  ASSERT_SAME(objs->zero, result);
+  ASSERT_SAME(objs->max, carry);
+
+  result = uint256_muladd(objs->zero, objs->max, objs->wild, &carry); // 0*MAX + x = x
+  ASSERT_SAME(objs->wild, result);
+  ASSERT_SAME(objs->zero, carry);
+
+  uint32_t a_data[8] = { 0x196e5c4dU, 0xca0a5ed3U, 0x8f30e466U, 0xc4af27c1U, 0x4b7fa5b0U, 0x84f6d706U, 0xb68e753eU, 0x4ed4d335U };
+  uint32_t b_data[8] = { 0xd099c673U, 0x7f0672b7U, 0xc0336d91U, 0x44fe4badU, 0x39e27f62U, 0x301b9dc4U, 0x1bc698a0U, 0xdedd27daU };
+  uint32_t c_data[8] = { 0x3673598fU, 0x89f0849eU, 0xa264d995U, 0x2e03c8d8U, 0x6320966eU, 0x31e85fb4U, 0x9ced18d9U, 0xbd371535U };
+  uint32_t lo_data[8] = { 0xb86f5e26U, 0x3290861cU, 0x51f4547cU, 0x212af0b8U, 0x9783fe8fU, 0x76e914bfU, 0xbeb1fdf7U, 0x63c63575U };
+  uint32_t hi_data[8] = { 0x63599e82U, 0xe5d5ed84U, 0xd2f2fbfeU, 0x2ff15477U, 0x2b15f496U, 0x4e7bbc32U, 0x7fa4c716U, 0x44a0a928U };
+  UInt256 a, b, c, lo, hi;
+  INIT_FROM_ARR(a, a_data);
+  INIT_FROM_ARR(b, b_data);
+  INIT_FROM_ARR(c, c_data);
+  INIT_FROM_ARR(lo, lo_data);
+  INIT_FROM_ARR(hi, hi_data);
+  result = uint256_muladd(a, b, c, &carry);
+  ASSERT_SAME(lo, result);
+  ASSERT_SAME(hi, carry);
+}
+
+void test_dot_n(TestObjs *objs) {
+  UInt256 result, hi;
+
+  result = uint256_dot_n_wide(NULL, NULL, 0, &hi);   // empty dot product is 0
+  ASSERT_SAME(objs->zero, result);
+  ASSERT_SAME(objs->zero, hi);
+
+  // MAX*MAX + 1*MAX = MAX * 2^256
+  UInt256 left[2] = { objs->max, objs->one };
+  UInt256 right[2] = { objs->max, objs->max };
+  result = uint256_dot_n_wide(left, right, 2, &hi);
+  ASSERT_SAME(objs->zero, result);
+  ASSERT_SAME(objs->max, hi);
+
+  // large enough to take the multithreaded path; must agree with a
+  // serial 512-bit sum of muladd results
+  size_t n = 100000;
+  UInt256 *a = malloc(n * sizeof(UInt256));
+  UInt256 *b = malloc(n * sizeof(UInt256));
+  UInt256 expected = objs->zero, expectedHi = objs->zero, carry;
+  for (size_t i = 0; i < n; i++) {
+    a[i] = uint256_rotate_left(objs->wild, (unsigned) i);
+    b[i] = uint256_sub(objs->max, uint256_create_from_u32((uint32_t) i));
+    expected = uint256_muladd(a[i], b[i], expected, &carry);
+    expectedHi = uint256_add(expectedHi, carry);
+  }
+  ASSERT(!uint256_is_zero(expectedHi));
+  result = uint256_dot_n_wide(a, b, n, &hi);
+  ASSERT_SAME(expected, result);
+  ASSERT_SAME(expectedHi, hi);
+  result = uint256_dot_n(a, b, n);
+  free(a);
+  free(b);
+  ASSERT_SAME(expected, result);
+}
+
+void test_accumulator(TestObjs *objs) {
+  UInt256Accumulator acc;
+  UInt256 result;
+
+  uint256_accumulator_init(&acc);                  // empty sum is 0
+  result = uint256_accumulator_value(&acc);
+  ASSERT_SAME(objs->zero, result);
+
+  uint256_accumulator_add(&acc, objs->max);        // MAX + 1 = 0 (overflow)
+  uint256_accumulator_add(&acc, objs->one);
+  result = uint256_accumulator_value(&acc);
+  ASSERT_SAME(objs->zero, result);
+
+  uint256_accumulator_add(&acc, objs->max);        // reading keeps the running sum: 0 + MAX + MAX
+  uint256_accumulator_add(&acc, objs->max);
+  result = uint256_accumulator_value(&acc);
+  ASSERT_SAME(objs->one_below_max, result);
+
+  // bulk add must agree with a uint256_add chain
+  UInt256 vals[1000];
+  UInt256 expected = objs->zero;
+  for (unsigned i = 0; i < 1000; i++) {
+    vals[i] = uint256_rotate_right(objs->max, i);
+    vals[i].data[i % 8] ^= objs->wild.data[(i + 1) % 8];
+    expected = uint256_add(expected, vals[i]);
+  }
+  uint256_accumulator_init(&acc);
+  uint256_accumulator_add_n(&acc, vals, 1000);
+  result = uint256_accumulator_value(&acc);
+  ASSERT_SAME(expected, result);
+}
+
+void test_compare(TestObjs *objs) {
+  ASSERT(uint256_is_zero(objs->zero));
+  ASSERT(!uint256_is_zero(objs->msb_set));
+
+  ASSERT(0 == uint256_compare(objs->zero, objs->zero));
+  ASSERT(0 == uint256_compare(objs->wild, objs->wild));
+  ASSERT(uint256_compare(objs->zero, objs->one) < 0);
+  ASSERT(uint256_compare(objs->one, objs->zero) > 0);
+  ASSERT(uint256_compare(objs->one_below_max, objs->max) < 0);
+  ASSERT(uint256_compare(objs->msb_set, objs->wild) < 0);   // top limbs decide
+}
+
+void test_shift(TestObjs *objs) {
+  UInt256 result;
+
+  result = uint256_shift_left(objs->wild, 0);
+  ASSERT_SAME(objs->wild, result);
+
+  result = uint256_shift_left(objs->one, 255);
+  ASSERT_SAME(objs->msb_set, result);
+
+  result = uint256_shift_left(objs->msb_set, 1);       // shifted out, not rotated
+  ASSERT_SAME(objs->zero, result);
+
+  result = uint256_shift_left(objs->max, 256);
+  ASSERT_SAME(objs->zero, result);
+
+  result = uint256_shift_right(objs->msb_set, 255);
+  ASSERT_SAME(objs->one, result);
+
+  result = uint256_shift_right(objs->one, 1);
+  ASSERT_SAME(objs->zero, result);
+
+  // wild value shifted left by 36 bits:
+  //   00000000 00000000 00000000 00000000 00000000 00000000 00000AB0 00000000
+  result = uint256_shift_left(objs->wild, 36);
+  ASSERT(0U == result.data[0]);
+  ASSERT(0x00000AB0U == result.data[1]);
+  for (int i = 2; i < 8; i++) {
+    ASSERT(0U == result.data[i]);
+  }
+
+  // wild value shifted right by 36 bits:
+  //   00000000 0CD00000 00000000 00000000 00000000 00000000 00000000 00000000
+  result = uint256_shift_right(objs->wild, 36);
+  ASSERT(0x0CD00000U == result.data[6]);
+  ASSERT(0U == result.data[7]);
+  for (int i = 0; i < 6; i++) {
+    ASSERT(0U == result.data[i]);
+  }
+}
+
+void test_divmod(TestObjs *objs) {
+  UInt256 result, remainder;
+
+  result = uint256_divmod(objs->wild, objs->one, &remainder);   // x / 1
+  ASSERT_SAME(objs->wild, result);
+  ASSERT_SAME(objs->zero, remainder);
+
+  result = uint256_divmod(objs->one, objs->max, &remainder);    // 1 / MAX
+  ASSERT_SAME(objs->zero, result);
+  ASSERT_SAME(objs->one, remainder);
+
+  result = uint256_divmod(objs->max, objs->max, &remainder);    // MAX / MAX
+  ASSERT_SAME(objs->one, result);
+  ASSERT_SAME(objs->zero, remainder);
+
+  result = uint256_divmod(objs->max, objs->msb_set, &remainder); // MAX / 2^255
+  ASSERT_SAME(objs->one, result);
+  ASSERT_SAME(uint256_sub(objs->msb_set, objs->one), remainder);
+
+  // single-limb divisor: MAX / 0xFFFFFFFF = 00000001 repeated
+  UInt256 expected;
+  set_all(&expected, 1U);
+  result = uint256_divmod(objs->max, uint256_create_from_u32(0xFFFFFFFFU), &remainder);
+  ASSERT_SAME(expected, result);
+  ASSERT_SAME(objs->zero, remainder);
+
+  uint32_t a_data[8] = { 0x7d832969U, 0xc3638360U, 0xf8578328U, 0x12c0ee22U, 0x58b429fdU, 0x48ef98ecU, 0xccef7d73U, 0xdd1f5fd5U };
+  uint32_t b_data[8] = { 0xba04cd61U, 0x54b9cad3U, 0x8ad3f7d5U, 0x5552c398U, 0x00000001U, 0U, 0U, 0U };
+  uint32_t q_data[8] = { 0x6a8324faU, 0x178a20b7U, 0x1668bd9bU, 0xa5d8c775U, 0U, 0U, 0U, 0U };
+  uint32_t r_data[8] = { 0xe54df4afU, 0x6faa8c9dU, 0x574a137bU, 0xbdd818a2U, 0U, 0U, 0U, 0U };
+  UInt256 a, b, q, r;
+  INIT_FROM_ARR(a, a_data);
+  INIT_FROM_ARR(b, b_data);
+  INIT_FROM_ARR(q, q_data);
+  INIT_FROM_ARR(r, r_data);
+  result = uint256_divmod(a, b, &remainder);
+  ASSERT_SAME(q, result);
+  ASSERT_SAME(r, remainder);
+
+  // q*b + r == a and r < b for divisors of every limb count
+  for (unsigned shift = 1; shift < 256; shift += 7) {
+    UInt256 divisor = uint256_shift_right(uint256_mul(b, a), shift);
+    if (uint256_is_zero(divisor)) {
+      continue;
+    }
+    result = uint256_divmod(a, divisor, &remainder);
+    ASSERT(uint256_compare(remainder, divisor) < 0);
+    ASSERT_SAME(a, uint256_add(uint256_mul(result, divisor), remainder));
+  }
+}
+
+void test_isqrt(TestObjs *objs) {
+  UInt256 result;
+
+  result = uint256_isqrt(objs->zero);
+  ASSERT_SAME(objs->zero, result);
+
+  result = uint256_isqrt(objs->one);
+  ASSERT_SAME(objs->one, result);
+
+  result = uint256_isqrt(uint256_create_from_u32(15U));   // floor(sqrt(15)) = 3
+  ASSERT_SAME(uint256_create_from_u32(3U), result);
+
+  result = uint256_isqrt(uint256_create_from_u32(16U));
+  ASSERT_SAME(uint256_create_from_u32(4U), result);
+
+  // sqrt(MAX) = 2^128 - 1
+  UInt256 expected = objs->zero;
+  expected.data[0] = expected.data[1] = expected.data[2] = expected.data[3] = 0xFFFFFFFFU;
+  result = uint256_isqrt(objs->max);
+  ASSERT_SAME(expected, result);
+
+  uint32_t val_data[8] = { 0x7d832969U, 0xc3638360U, 0xf8578328U, 0x12c0ee22U, 0x58b429fdU, 0x48ef98ecU, 0xccef7d73U, 0xdd1f5fd5U };
+  uint32_t root_data[8] = { 0xab362bfaU, 0x8a55658eU, 0x94470968U, 0xedec4c8aU, 0U, 0U, 0U, 0U };
+  UInt256 val, root;
+  INIT_FROM_ARR(val, val_data);
+  INIT_FROM_ARR(root, root_data);
+  result = uint256_isqrt(val);
+  ASSERT_SAME(root, result);
+}
+
+void test_gcd(TestObjs *objs) {
+  UInt256 result;
+
+  result = uint256_gcd(objs->wild, objs->zero);   // gcd(x, 0) = x
+  ASSERT_SAME(objs->wild, result);
+
+  result = uint256_gcd(objs->zero, objs->wild);
+  ASSERT_SAME(objs->wild, result);
+
+  result = uint256_gcd(objs->max, objs->one);
+  ASSERT_SAME(objs->one, result);
+
+  result = uint256_gcd(uint256_create_from_u32(48U), uint256_create_from_u32(180U));
+  ASSERT_SAME(uint256_create_from_u32(12U), result);
+
+  uint32_t x_data[8] = { 0x54663956U, 0x64183742U, 0x19f138bfU, 0xe7366628U, 0x2e9008e3U, 0x03b213cfU, 0x0001a979U, 0U };
+  uint32_t y_data[8] = { 0x8cb8fc38U, 0x4c53eeb7U, 0x7dafe0e8U, 0xde293f6fU, 0x81a0a80eU, 0x4b3c0c42U, 0x000223deU, 0U };
+  uint32_t gcd_data[8] = { 0xd951d85eU, 0x0ac7af5eU, 0U, 0U, 0U, 0U, 0U, 0U };
+  UInt256 x, y, gcd;
+  INIT_FROM_ARR(x, x_data);
+  INIT_FROM_ARR(y, y_data);
+  INIT_FROM_ARR(gcd, gcd_data);
+  result = uint256_gcd(x, y);
+  ASSERT_SAME(gcd, result);
+}
+
+void test_pow(TestObjs *objs) {
+  UInt256 result;
+  UInt256 three = uint256_create_from_u32(3U);
+
+  result = uint256_pow(objs->wild, 0);     // x^0 = 1
+  ASSERT_SAME(objs->one, result);
+
+  result = uint256_pow(objs->wild, 1);
+  ASSERT_SAME(objs->wild, result);
+
+  result = uint256_pow(uint256_create_from_u32(2U), 255);
+  ASSERT_SAME(objs->msb_set, result);
+
+  result = uint256_pow(uint256_create_from_u32(2U), 256);   // wraps to 0
+  ASSERT_SAME(objs->zero, result);
+
+  uint32_t pow150_data[8] = { 0x63c6e219U, 0x16e692fbU, 0xbdcf60ccU, 0x114c01ffU, 0x31b45ae7U, 0x1d6864a3U, 0xa2b98ca1U, 0x0000359bU };
+  uint32_t pow200_data[8] = { 0xaaf8b0a1U, 0x5bfaff1eU, 0xe4a7ae22U, 0x83ecf6f6U, 0x447606b6U, 0xfd73d97eU, 0x76f3432fU, 0xc21a937aU };
+  UInt256 pow150, pow200;
+  INIT_FROM_ARR(pow150, pow150_data);
+  INIT_FROM_ARR(pow200, pow200_data);
+
+  result = uint256_pow(three, 200);        // 3^200 mod 2^256
+  ASSERT_SAME(pow200, result);
+
+  ASSERT(uint256_pow_checked(three, 150, &result));
+  ASSERT_SAME(pow150, result);
+
+  result = objs->zero;
+  ASSERT(!uint256_pow_checked(three, 200, &result));   // overflow leaves result unchanged
+  ASSERT_SAME(objs->zero, result);
+
+  ASSERT(uint256_pow_checked(uint256_create_from_u32(2U), 255, &result));
+  ASSERT_SAME(objs->msb_set, result);
+  ASSERT(!uint256_pow_checked(uint256_create_from_u32(2U), 256, &result));
+
+  ASSERT(uint256_pow_checked(objs->one, UINT64_MAX, &result));
+  ASSERT_SAME(objs->one, result);
+}
+
+void test_signed_compare(TestObjs *objs) {
+  UInt256 minusTwo = uint256_create_from_i64(-2);
+  ASSERT_SAME(objs->one_below_max, minusTwo);
+  ASSERT_SAME(objs->one, uint256_create_from_i64(1));
+
+  ASSERT(uint256_signed_is_negative(objs->max));          // MAX is -1
+  ASSERT(uint256_signed_is_negative(objs->msb_set));      // 2^255 is the most negative value
+  ASSERT(!uint256_signed_is_negative(objs->one));
+  ASSERT(!uint256_signed_is_negative(objs->zero));
+
+  ASSERT(uint256_signed_compare(objs->max, objs->zero) < 0);        // -1 < 0
+  ASSERT(uint256_signed_compare(objs->zero, objs->max) > 0);
+  ASSERT(uint256_signed_compare(minusTwo, objs->max) < 0);          // -2 < -1
+  ASSERT(uint256_signed_compare(objs->msb_set, minusTwo) < 0);
+  ASSERT(uint256_signed_compare(objs->one, objs->zero) > 0);
+  ASSERT(0 == uint256_signed_compare(minusTwo, minusTwo));
+}
+
+void test_signed_shift_right(TestObjs *objs) {
+  UInt256 result;
+
+  result = uint256_signed_shift_right(objs->max, 100);      // -1 >> n = -1
+  ASSERT_SAME(objs->max, result);
+
+  result = uint256_signed_shift_right(uint256_create_from_i64(-8), 2);
+  ASSERT_SAME(uint256_create_from_i64(-2), result);
+
+  result = uint256_signed_shift_right(uint256_create_from_i64(-7), 1);  // rounds toward -infinity
+  ASSERT_SAME(uint256_create_from_i64(-4), result);
+
+  result = uint256_signed_shift_right(objs->msb_set, 255);
+  ASSERT_SAME(objs->max, result);
+
+  result = uint256_signed_shift_right(uint256_create_from_i64(-5), 300);
+  ASSERT_SAME(objs->max, result);
+
+  result = uint256_signed_shift_right(uint256_create_from_u32(8U), 2);   // positive values shift in zeros
+  ASSERT_SAME(uint256_create_from_u32(2U), result);
+}
+
+void test_signed_divmod(TestObjs *objs) {
+  UInt256 result, remainder;
+
+  result = uint256_signed_divmod(uint256_create_from_i64(-7), uint256_create_from_i64(2), &remainder);
+  ASSERT_SAME(uint256_create_from_i64(-3), result);
+  ASSERT_SAME(uint256_create_from_i64(-1), remainder);
+
+  result = uint256_signed_divmod(uint256_create_from_i64(7), uint256_create_from_i64(-2), &remainder);
+  ASSERT_SAME(uint256_create_from_i64(-3), result);
+  ASSERT_SAME(uint256_create_from_i64(1), remainder);
+
+  result = uint256_signed_divmod(uint256_create_from_i64(-7), uint256_create_from_i64(-2), &remainder);
+  ASSERT_SAME(uint256_create_from_i64(3), result);
+  ASSERT_SAME(uint256_create_from_i64(-1), remainder);
+
+  result = uint256_signed_divmod(objs->msb_set, objs->max, &remainder);   // MIN / -1 wraps
+  ASSERT_SAME(objs->msb_set, result);
+  ASSERT_SAME(objs->zero, remainder);
+
+  UInt256 a = uint256_create_from_hex("24e69725eabf11a56178bbad37dfaf2da9bd81f468c8b48c29e50397a49fb382");
+  UInt256 b = uint256_create_from_hex("5b4d792fb58bed491999e3dae");
+  UInt256 q = uint256_create_from_hex("6776f03b8744e8b64a2fa8d9a25c815d302fa08");
+  UInt256 r = uint256_create_from_hex("51ab933908d468fad6a15da12");
+  result = uint256_signed_divmod(uint256_negate(a), b, &remainder);
+  ASSERT_SAME(uint256_negate(q), result);
+  ASSERT_SAME(uint256_negate(r), remainder);
+}
+
+void test_signed_format_as_decimal(TestObjs *objs) {
+  char *s;
+
+  s = uint256_signed_format_as_decimal(objs->zero);
+  ASSERT(0 == strcmp("0", s));
+  free(s);
+
+  s = uint256_signed_format_as_decimal(objs->max);
+  ASSERT(0 == strcmp("-1", s));
+  free(s);
+
+  s = uint256_signed_format_as_decimal(uint256_create_from_i64(-1234567890123LL));
+  ASSERT(0 == strcmp("-1234567890123", s));
+  free(s);
+
+  s = uint256_signed_format_as_decimal(objs->msb_set);
+  ASSERT(0 == strcmp("-57896044618658097711785492504343953926634992332820282019728792003956564819968", s));
+  free(s);
+
+  s = uint256_signed_format_as_decimal(uint256_sub(objs->msb_set, objs->one));
+  ASSERT(0 == strcmp("57896044618658097711785492504343953926634992332820282019728792003956564819967", s));
+  free(s);
+}
+
 void test_rotate_left(TestObjs *objs) {
   UInt256 result;
 
@@ -572,3 +1199,869 @@ void test_rotate_right(TestObjs *objs) {
   ASSERT(0x0000ABCDU == result.data[6]);
   ASSERT(0U == result.data[7]);
 }
+
+void test_stats(TestObjs *objs) {
+  char *s;
+
+#ifdef UINT256_STATS
+  uint256_stats_reset();
+  for (int i = 0; i < 3; i++) {
+    free(uint256_format_as_hex(objs->wild));   // 64 digits + null terminator each
+  }
+  uint256_create_from_hex("ab");
+
+  s = uint256_stats_dump();
+  ASSERT(0 == strncmp("{\"enabled\":true,", s, 16));
+  ASSERT(NULL != strstr(s, "\"format_as_hex\":{\"calls\":3,\"bytes_allocated\":195,"));
+  ASSERT(NULL != strstr(s, "\"create_from_hex\":{\"calls\":1,"));
+  ASSERT(NULL != strstr(s, "\"divmod\":{\"calls\":0,"));
+  free(s);
+#else
+  (void) objs;
+  s = uint256_stats_dump();
+  ASSERT(0 == strcmp("{\"enabled\":false}", s));
+  free(s);
+#endif
+}
+
+void test_ct_compare_select(TestObjs *objs) {
+  ASSERT(1U == uint256_ct_is_zero(objs->zero));
+  ASSERT(0U == uint256_ct_is_zero(objs->msb_set));
+  ASSERT(0U == uint256_ct_is_zero(objs->one));
+
+  ASSERT(1U == uint256_ct_eq(objs->wild, objs->wild));
+  ASSERT(0U == uint256_ct_eq(objs->max, objs->one_below_max));
+
+  ASSERT(1U == uint256_ct_lt(objs->one_below_max, objs->max));
+  ASSERT(0U == uint256_ct_lt(objs->max, objs->one_below_max));
+  ASSERT(0U == uint256_ct_lt(objs->max, objs->max));
+
+  ASSERT(-1 == uint256_ct_compare(objs->zero, objs->one));
+  ASSERT(0 == uint256_ct_compare(objs->wild, objs->wild));
+  ASSERT(1 == uint256_ct_compare(objs->wild, objs->msb_set));
+
+  UInt256 result;
+  result = uint256_ct_select(1U, objs->wild, objs->max);
+  ASSERT_SAME(objs->wild, result);
+  result = uint256_ct_select(0U, objs->wild, objs->max);
+  ASSERT_SAME(objs->max, result);
+
+  UInt256 a = objs->wild;
+  UInt256 b = objs->one;
+  uint256_ct_swap(0U, &a, &b);
+  ASSERT_SAME(objs->wild, a);
+  ASSERT_SAME(objs->one, b);
+  uint256_ct_swap(1U, &a, &b);
+  ASSERT_SAME(objs->one, a);
+  ASSERT_SAME(objs->wild, b);
+}
+
+void test_ct_add_sub(TestObjs *objs) {
+  UInt256 result;
+  uint32_t carry, borrow;
+
+  result = uint256_ct_add(objs->max, objs->one, &carry);     // MAX + 1 = 0 carry 1
+  ASSERT_SAME(objs->zero, result);
+  ASSERT(1U == carry);
+
+  result = uint256_ct_add(objs->wild, objs->one, &carry);
+  ASSERT_SAME(uint256_add(objs->wild, objs->one), result);
+  ASSERT(0U == carry);
+
+  result = uint256_ct_sub(objs->zero, objs->one, &borrow);   // 0 - 1 = MAX borrow 1
+  ASSERT_SAME(objs->max, result);
+  ASSERT(1U == borrow);
+
+  result = uint256_ct_sub(objs->max, objs->one, &borrow);
+  ASSERT_SAME(objs->one_below_max, result);
+  ASSERT(0U == borrow);
+}
+
+void test_ct_mod(TestObjs *objs) {
+  // m = 2^255 - 19
+  uint32_t m_data[8] = { 0xffffffedU, 0xffffffffU, 0xffffffffU, 0xffffffffU, 0xffffffffU, 0xffffffffU, 0xffffffffU, 0x7fffffffU };
+  uint32_t a_data[8] = { 0x72a09623U, 0xa2054144U, 0x6b030c55U, 0x17bb6ef6U, 0x6c625769U, 0xc7b4a9eaU, 0x321d947aU, 0x09df2da1U };
+  uint32_t b_data[8] = { 0x6888fa59U, 0x40ca461dU, 0x56ec9e12U, 0x6d33fa9dU, 0xc2d90cceU, 0xefa815eaU, 0x19fe068bU, 0x038e59c5U };
+  uint32_t mul_data[8] = { 0x4af538a7U, 0x5ab2bfc1U, 0xb83514c8U, 0xdefa478cU, 0x8dd797c9U, 0xb2cfb6f8U, 0xa16474baU, 0x66d9f12eU };
+  uint32_t add_data[8] = { 0xdb29907cU, 0xe2cf8761U, 0xc1efaa67U, 0x84ef6993U, 0x2f3b6437U, 0xb75cbfd5U, 0x4c1b9b06U, 0x0d6d8766U };
+  uint32_t sub_data[8] = { 0xf5e86423U, 0x9ec504d8U, 0xebe991bcU, 0x55788ba6U, 0x5676b565U, 0x27f36c00U, 0xe7e07211U, 0x79af2c23U };
+  UInt256 m, a, b, expected, result;
+  INIT_FROM_ARR(m, m_data);
+  INIT_FROM_ARR(a, a_data);
+  INIT_FROM_ARR(b, b_data);
+
+  INIT_FROM_ARR(expected, mul_data);
+  result = uint256_ct_mulmod(a, b, m);
+  ASSERT_SAME(expected, result);
+
+  INIT_FROM_ARR(expected, add_data);
+  result = uint256_ct_addmod(a, b, m);
+  ASSERT_SAME(expected, result);
+
+  INIT_FROM_ARR(expected, sub_data);
+  result = uint256_ct_submod(b, a, m);       // wraps around m
+  ASSERT_SAME(expected, result);
+  result = uint256_ct_submod(a, b, m);
+  ASSERT_SAME(uint256_sub(a, b), result);
+
+  // (m-1) + (m-1) = m - 2, (m-1)*(m-1) = 1
+  UInt256 mMinusOne = uint256_sub(m, objs->one);
+  result = uint256_ct_addmod(mMinusOne, mMinusOne, m);
+  ASSERT_SAME(uint256_sub(mMinusOne, objs->one), result);
+  result = uint256_ct_mulmod(mMinusOne, mMinusOne, m);
+  ASSERT_SAME(objs->one, result);
+
+  // modulus with the top bit set: sums carry out of 256 bits
+  result = uint256_ct_addmod(objs->one_below_max, objs->one_below_max, objs->max);
+  ASSERT_SAME(uint256_sub(objs->one_below_max, objs->one), result);
+  result = uint256_ct_mulmod(objs->one_below_max, objs->one_below_max, objs->max);
+  ASSERT_SAME(objs->one, result);
+
+  // must agree with uint256_mulmod for moduli of every size, odd or even
+  UInt256Rng rng;
+  uint256_rng_seed(&rng, 34U);
+  for (unsigned bits = 1; bits <= 256; bits += 5) {
+    for (int i = 0; i < 20; i++) {
+      UInt256 mod = uint256_shift_right(uint256_random(&rng), 256 - bits);
+      mod = uint256_set_bit(mod, bits - 1, 1);
+      a = uint256_random(&rng);
+      b = uint256_random(&rng);
+      expected = uint256_mulmod(a, b, mod);
+      result = uint256_ct_mulmod(a, b, mod);
+      ASSERT_SAME(expected, result);
+    }
+  }
+}
+
+void test_ct_rotate_left(TestObjs *objs) {
+  for (unsigned nbits = 0; nbits <= 300; nbits++) {
+    UInt256 expected = uint256_rotate_left(objs->wild, nbits);
+    UInt256 result = uint256_ct_rotate_left(objs->wild, nbits);
+    ASSERT_SAME(expected, result);
+  }
+}
+
+void test_ct_create_from_hex(TestObjs *objs) {
+  UInt256 result;
+
+  result = uint256_ct_create_from_hex("cd000000000000000000000000000000000000000000000000000000000000ab");
+  ASSERT_SAME(objs->wild, result);
+
+  result = uint256_ct_create_from_hex("CD000000000000000000000000000000000000000000000000000000000000AB");
+  ASSERT_SAME(objs->wild, result);
+
+  result = uint256_ct_create_from_hex("0000000000000000000000000000000000000000000000000000000000000001");
+  ASSERT_SAME(objs->one, result);
+
+  result = uint256_ct_create_from_hex("ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
+  ASSERT_SAME(objs->max, result);
+
+  result = uint256_ct_create_from_hex("0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef");
+  ASSERT_SAME(uint256_create_from_hex("0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef"), result);
+}
+
+void test_mulmod(TestObjs *objs) {
+  UInt256 m = uint256_create_from_hex("7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed");
+  UInt256 result;
+
+  result = uint256_mulmod(objs->max, objs->max, objs->one);   // anything mod 1 is 0
+  ASSERT_SAME(objs->zero, result);
+
+  result = uint256_mulmod(objs->max, objs->max, uint256_create_from_u32(10U));   // 5 * 5 mod 10
+  ASSERT_SAME(uint256_create_from_u32(5U), result);
+
+  // must agree with the (slower) constant-time version
+  UInt256 a = objs->wild;
+  UInt256 b = objs->one_below_max;
+  for (int i = 0; i < 50; i++) {
+    UInt256 reducedA = uint256_ct_mulmod(a, objs->one, m);
+    UInt256 reducedB = uint256_ct_mulmod(b, objs->one, m);
+    ASSERT_SAME(uint256_ct_mulmod(reducedA, reducedB, m), uint256_mulmod(a, b, m));
+    ASSERT_SAME(uint256_ct_mulmod(a, b, objs->max), uint256_mulmod(a, b, objs->max));
+    a = uint256_rotate_left(uint256_mul(a, b), 17);
+    b = uint256_add(b, a);
+  }
+}
+
+void test_mod_pow(TestObjs *objs) {
+  UInt256 p = uint256_create_from_hex("7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed");
+  UInt256 a = uint256_create_from_hex("09df2da1321d947ac7b4a9ea6c62576917bb6ef66b030c55a205414472a09623");
+  UInt256 result;
+
+  result = uint256_mod_pow(a, objs->zero, p);   // a^0 = 1
+  ASSERT_SAME(objs->one, result);
+
+  result = uint256_mod_pow(a, objs->zero, objs->one);   // but everything mod 1 is 0
+  ASSERT_SAME(objs->zero, result);
+
+  result = uint256_mod_pow(a, uint256_sub(p, objs->one), p);   // Fermat: a^(p-1) = 1
+  ASSERT_SAME(objs->one, result);
+
+  result = uint256_mod_pow(a, uint256_create_from_hex("deadbeefcafebabe1234567890abcdef"), p);
+  ASSERT_SAME(uint256_create_from_hex("43835385cf33be37e00e4f1fd3e910be4eb610894c22063e442e25e06542087b"), result);
+}
+
+void test_mod_inv(TestObjs *objs) {
+  UInt256 p = uint256_create_from_hex("7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed");
+  UInt256 inv;
+
+  ASSERT(uint256_mod_inv(objs->one, p, &inv));
+  ASSERT_SAME(objs->one, inv);
+
+  ASSERT(uint256_mod_inv(uint256_create_from_u32(3U), uint256_create_from_u32(7U), &inv));   // 3 * 5 = 15 = 1 mod 7
+  ASSERT_SAME(uint256_create_from_u32(5U), inv);
+
+  ASSERT(uint256_mod_inv(objs->wild, p, &inv));
+  ASSERT_SAME(objs->one, uint256_mulmod(objs->wild, inv, p));
+
+  ASSERT(uint256_mod_inv(objs->one_below_max, objs->max, &inv));   // values above 2^255
+  ASSERT_SAME(objs->one, uint256_mulmod(objs->one_below_max, inv, objs->max));
+
+  ASSERT(!uint256_mod_inv(objs->zero, p, &inv));
+  ASSERT(!uint256_mod_inv(uint256_create_from_u32(6U), uint256_create_from_u32(9U), &inv));   // gcd is 3
+}
+
+void test_mod_inv_batch(TestObjs *objs) {
+  UInt256 p = uint256_create_from_hex("7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed");
+  UInt256 in[20], out[20];
+  for (int i = 0; i < 20; i++) {
+    in[i] = uint256_add(uint256_rotate_left(objs->wild, i * 13), uint256_create_from_u32(i));
+  }
+
+  ASSERT(uint256_mod_inv_batch(in, out, 0, p));
+  ASSERT(uint256_mod_inv_batch(in, out, 20, p));
+  for (int i = 0; i < 20; i++) {
+    UInt256 inv;
+    ASSERT(uint256_mod_inv(in[i], p, &inv));
+    ASSERT_SAME(inv, out[i]);
+  }
+
+  in[7] = objs->zero;   // one non-invertible value fails the batch
+  ASSERT(!uint256_mod_inv_batch(in, out, 20, p));
+}
+
+void test_mod_multiexp(TestObjs *objs) {
+  UInt256 p = uint256_create_from_hex("7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed");
+  UInt256 bases[5], exps[5];
+  UInt256 expected = objs->one;
+  for (int i = 0; i < 5; i++) {
+    bases[i] = uint256_rotate_right(objs->wild, i * 31);
+    exps[i] = uint256_shift_right(uint256_rotate_left(objs->max, i), i * 40);   // exponents of different lengths
+    expected = uint256_mulmod(expected, uint256_mod_pow(bases[i], exps[i], p), p);
+  }
+
+  UInt256 result = uint256_mod_multiexp(bases, exps, 5, p);
+  ASSERT_SAME(expected, result);
+
+  result = uint256_mod_multiexp(bases, exps, 0, p);   // empty product is 1
+  ASSERT_SAME(objs->one, result);
+
+  exps[0] = objs->zero;
+  exps[1] = objs->one;
+  result = uint256_mod_multiexp(bases, exps, 2, p);   // b0^0 * b1^1 = b1
+  ASSERT_SAME(bases[1], result);
+}
+
+void test_map(TestObjs *objs) {
+  UInt256Map map;
+  uint64_t value;
+
+  ASSERT(uint256_map_init(&map, 0));
+  ASSERT(0U == uint256_map_size(&map));
+  ASSERT(!uint256_map_get(&map, objs->zero, &value));
+
+  ASSERT(1 == uint256_map_put(&map, objs->zero, 10U));
+  ASSERT(1 == uint256_map_put(&map, objs->max, 20U));
+  ASSERT(1 == uint256_map_put(&map, objs->wild, 30U));
+  ASSERT(0 == uint256_map_put(&map, objs->max, 21U));   // replaces the value
+  ASSERT(3U == uint256_map_size(&map));
+
+  ASSERT(uint256_map_get(&map, objs->zero, &value));
+  ASSERT(10U == value);
+  ASSERT(uint256_map_get(&map, objs->max, &value));
+  ASSERT(21U == value);
+  ASSERT(uint256_map_get(&map, objs->wild, NULL));
+  ASSERT(!uint256_map_get(&map, objs->one_below_max, &value));
+
+  UInt256 keys[4] = { objs->wild, objs->one, objs->zero, objs->msb_set };
+  uint64_t values[4] = { 0U, 99U, 0U, 99U };
+  unsigned char found[4];
+  uint256_map_get_batch(&map, keys, 4, values, found);
+  ASSERT(found[0] && 30U == values[0]);
+  ASSERT(!found[1] && 99U == values[1]);
+  ASSERT(found[2] && 10U == values[2]);
+  ASSERT(!found[3] && 99U == values[3]);
+
+  ASSERT(uint256_map_remove(&map, objs->zero));
+  ASSERT(!uint256_map_remove(&map, objs->zero));
+  ASSERT(!uint256_map_get(&map, objs->zero, &value));
+  ASSERT(2U == uint256_map_size(&map));
+
+  uint256_map_destroy(&map);
+}
+
+void test_map_grow_and_remove(TestObjs *objs) {
+  UInt256Map map;
+  ASSERT(uint256_map_init(&map, 4));
+
+  // keys that differ only in high limbs, to exercise growth and probing
+  const unsigned n = 5000;
+  for (unsigned i = 0; i < n; i++) {
+    UInt256 key = objs->zero;
+    key.data[7] = i * 2654435761U;
+    key.data[5] = i;
+    ASSERT(1 == uint256_map_put(&map, key, i));
+  }
+  ASSERT(n == uint256_map_size(&map));
+
+  // remove the even keys, re-add some, and check everything
+  for (unsigned i = 0; i < n; i += 2) {
+    UInt256 key = objs->zero;
+    key.data[7] = i * 2654435761U;
+    key.data[5] = i;
+    ASSERT(uint256_map_remove(&map, key));
+  }
+  for (unsigned round = 0; round < 3; round++) {
+    for (unsigned i = 0; i < n; i += 4) {
+      UInt256 key = objs->zero;
+      key.data[7] = i * 2654435761U;
+      key.data[5] = i;
+      ASSERT(1 == uint256_map_put(&map, key, i + round));
+      ASSERT(uint256_map_remove(&map, key));
+    }
+  }
+  ASSERT(n / 2 == uint256_map_size(&map));
+
+  for (unsigned i = 0; i < n; i++) {
+    UInt256 key = objs->zero;
+    key.data[7] = i * 2654435761U;
+    key.data[5] = i;
+    uint64_t value;
+    int present = uint256_map_get(&map, key, &value);
+    ASSERT(present == (int) (i % 2));
+    if (present) {
+      ASSERT(i == value);
+    }
+  }
+
+  uint256_map_destroy(&map);
+}
+
+void test_set(TestObjs *objs) {
+  UInt256Set set;
+  ASSERT(uint256_set_init(&set, 100));
+
+  ASSERT(1 == uint256_set_add(&set, objs->wild));
+  ASSERT(0 == uint256_set_add(&set, objs->wild));
+  ASSERT(1 == uint256_set_add(&set, objs->one));
+  ASSERT(2U == uint256_set_size(&set));
+
+  ASSERT(uint256_set_contains(&set, objs->wild));
+  ASSERT(!uint256_set_contains(&set, objs->zero));
+
+  UInt256 keys[3] = { objs->one, objs->max, objs->wild };
+  unsigned char found[3];
+  uint256_set_contains_batch(&set, keys, 3, found);
+  ASSERT(found[0] && !found[1] && found[2]);
+
+  ASSERT(uint256_set_remove(&set, objs->one));
+  ASSERT(!uint256_set_contains(&set, objs->one));
+  ASSERT(1U == uint256_set_size(&set));
+
+  uint256_set_destroy(&set);
+}
+
+// Encode vals, decode them again, and return the encoded size
+// (or 0 if the values didn't come back unchanged).
+static size_t column_round_trip(const UInt256 *vals, size_t n) {
+  unsigned char *buf = malloc(uint256_column_encoded_size_bound(n));
+  UInt256 *decoded = malloc((n + 1) * sizeof(UInt256));
+  size_t size = uint256_column_encode(vals, n, buf);
+
+  UInt256Column col;
+  int ok = uint256_column_open_buffer(&col, buf, size) &&
+    uint256_column_count(&col) == n &&
+    uint256_column_decode(&col, decoded);
+  for (size_t i = 0; ok && i < n; i++) {
+    ok = uint256_compare(vals[i], decoded[i]) == 0;
+  }
+  uint256_column_close(&col);
+  free(buf);
+  free(decoded);
+  return ok ? size : 0;
+}
+
+void test_column_round_trip(TestObjs *objs) {
+  size_t n = 5000;   // several full blocks and a partial one
+  UInt256 *vals = malloc(n * sizeof(UInt256));
+  uint64_t state = 0x9e3779b97f4a7c15U;
+
+  // small values: only the low limb is used
+  for (size_t i = 0; i < n; i++) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    vals[i] = uint256_create_from_u32((uint32_t) (state >> 44));
+  }
+  size_t size = column_round_trip(vals, n);
+  ASSERT(size > 0 && size < n * sizeof(UInt256) / 8);
+
+  // sorted large values (e.g., ids near a big base) use deltas
+  for (size_t i = 0; i < n; i++) {
+    vals[i] = uint256_add(objs->wild, uint256_create_from_u32((uint32_t) (i * 3)));
+  }
+  size = column_round_trip(vals, n);
+  ASSERT(size > 0 && size < n * sizeof(UInt256) / 8);
+
+  // random values don't compress, but must still round trip
+  for (size_t i = 0; i < n; i++) {
+    for (int j = 0; j < 8; j++) {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      vals[i].data[j] = (uint32_t) (state >> 32) >> (j * 4);
+    }
+  }
+  ASSERT(column_round_trip(vals, n) <= uint256_column_encoded_size_bound(n));
+  ASSERT(column_round_trip(vals, n) > 0);
+
+  // edge cases: all zero, all max, a single value and no values
+  for (size_t i = 0; i < n; i++) {
+    vals[i] = (i < 2048) ? objs->zero : objs->max;
+  }
+  ASSERT(column_round_trip(vals, n) > 0);
+  ASSERT(column_round_trip(vals, 1) > 0);
+  ASSERT(column_round_trip(vals, 0) > 0);
+
+  free(vals);
+}
+
+void test_column_file(TestObjs *objs) {
+  size_t n = 3000;
+  UInt256 *vals = malloc(n * sizeof(UInt256));
+  UInt256 *decoded = malloc(n * sizeof(UInt256));
+  for (size_t i = 0; i < n; i++) {
+    vals[i] = uint256_create_from_u32((uint32_t) i);
+    vals[i].data[2] = (uint32_t) (i % 7);
+  }
+  vals[n - 1] = objs->wild;
+
+  char path[] = "/tmp/uint256_column_XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT(fd >= 0);
+  close(fd);
+  ASSERT(uint256_column_write(path, vals, n));
+
+  UInt256Column col;
+  ASSERT(uint256_column_open(&col, path));
+  ASSERT(n == uint256_column_count(&col));
+  // blocks can be decoded on their own
+  ASSERT(UINT256_COLUMN_BLOCK_SIZE == uint256_column_decode_block(&col, 1, decoded));
+  ASSERT_SAME(vals[UINT256_COLUMN_BLOCK_SIZE + 5], decoded[5]);
+  ASSERT(n - 2 * UINT256_COLUMN_BLOCK_SIZE == uint256_column_decode_block(&col, 2, decoded));
+  ASSERT(0U == uint256_column_decode_block(&col, 3, decoded));
+  ASSERT(uint256_column_decode(&col, decoded));
+  for (size_t i = 0; i < n; i++) {
+    ASSERT_SAME(vals[i], decoded[i]);
+  }
+  uint256_column_close(&col);
+  unlink(path);
+  ASSERT(!uint256_column_open(&col, path));
+
+  // truncated or corrupt data is rejected rather than read past
+  unsigned char *buf = malloc(uint256_column_encoded_size_bound(n));
+  size_t size = uint256_column_encode(vals, n, buf);
+  ASSERT(uint256_column_open_buffer(&col, buf, size - 10));
+  ASSERT(!uint256_column_decode(&col, decoded));
+  // a huge count must not wrap around to match a small block count
+  memset(buf + 8, 0xff, 8);
+  memset(buf + 16, 0, 8);
+  ASSERT(!uint256_column_open_buffer(&col, buf, size));
+  buf[0] = 'X';
+  ASSERT(!uint256_column_open_buffer(&col, buf, size));
+
+  free(buf);
+  free(vals);
+  free(decoded);
+}
+
+void test_sum_and_prefix_sum(TestObjs *objs) {
+  // large enough to be split across threads
+  size_t n = 300000;
+  UInt256 *vals = malloc(n * sizeof(UInt256));
+  UInt256 *sums = malloc(n * sizeof(UInt256));
+  UInt256 *expected = malloc(n * sizeof(UInt256));
+  UInt256 total = objs->zero;
+  for (size_t i = 0; i < n; i++) {
+    vals[i] = uint256_rotate_left(objs->wild, (unsigned) i);
+    total = uint256_add(total, vals[i]);
+    expected[i] = total;
+  }
+
+  // the results must not depend on the number of threads
+  unsigned threadCounts[] = { 1, 2, 7, 16 };
+  for (int t = 0; t < 4; t++) {
+    uint256_set_num_threads(threadCounts[t]);
+    uint256_prefix_sum(vals, sums, n);
+    for (size_t i = 0; i < n; i++) {
+      ASSERT(0 == uint256_compare(expected[i], sums[i]));
+    }
+    UInt256 sum = uint256_sum(vals, n);
+    ASSERT_SAME(total, sum);
+  }
+
+  // in place, with wraparound
+  UInt256 small[3] = { objs->max, objs->one, objs->max };
+  uint256_prefix_sum(small, small, 3);
+  ASSERT_SAME(objs->max, small[0]);
+  ASSERT_SAME(objs->zero, small[1]);
+  ASSERT_SAME(objs->max, small[2]);
+
+  UInt256 sum = uint256_sum(vals, 0);
+  ASSERT_SAME(objs->zero, sum);
+  uint256_prefix_sum(vals, sums, 0);
+
+  free(vals);
+  free(sums);
+  free(expected);
+}
+
+void test_min_max(TestObjs *objs) {
+  size_t n = 300000;
+  UInt256 *vals = malloc(n * sizeof(UInt256));
+  for (size_t i = 0; i < n; i++) {
+    vals[i] = uint256_add(objs->wild, uint256_create_from_u32((uint32_t) (i * 2654435761U)));
+  }
+  vals[123456] = objs->one;
+  vals[234567] = objs->one_below_max;
+  UInt256 result;
+  unsigned threadCounts[] = { 1, 2, 7, 16 };
+  for (int t = 0; t < 4; t++) {
+    uint256_set_num_threads(threadCounts[t]);
+    result = uint256_min(vals, n);
+    ASSERT_SAME(objs->one, result);
+    result = uint256_max(vals, n);
+    ASSERT_SAME(objs->one_below_max, result);
+  }
+  result = uint256_min(vals, 1);
+  ASSERT_SAME(objs->wild, result);
+  result = uint256_max(vals, 1);
+  ASSERT_SAME(objs->wild, result);
+
+  // identities for an empty array
+  result = uint256_min(vals, 0);
+  ASSERT_SAME(objs->max, result);
+  result = uint256_max(vals, 0);
+  ASSERT_SAME(objs->zero, result);
+
+  free(vals);
+}
+
+void test_random(TestObjs *objs) {
+  (void) objs;
+  UInt256Rng rng, other;
+
+  // xoshiro256** seeded through splitmix64 (as in the reference code)
+  uint256_rng_seed(&rng, 0U);
+  UInt256 first = uint256_random(&rng);
+  UInt256 expected = uint256_create_from_hex("6aa594f1262d2d2c1a5f849d4933e6e0bf6e1f784956452a99ec5f36cb75f2b4");
+  ASSERT_SAME(expected, first);
+
+  // the same seed gives the same sequence, and fill matches single calls
+  UInt256 vals[100];
+  uint256_rng_seed(&other, 0U);
+  uint256_random_fill(&other, vals, 100);
+  ASSERT_SAME(first, vals[0]);
+  for (int i = 1; i < 100; i++) {
+    UInt256 next = uint256_random(&rng);
+    ASSERT_SAME(next, vals[i]);
+  }
+  ASSERT(0 == uint256_compare(uint256_random(&rng), uint256_random(&other)));
+
+  // other seeds and jumped streams differ
+  uint256_rng_seed(&other, 1U);
+  ASSERT(uint256_compare(first, uint256_random(&other)) != 0);
+  uint256_rng_seed(&other, 0U);
+  uint256_rng_jump(&other);
+  ASSERT(uint256_compare(first, uint256_random(&other)) != 0);
+
+  // roughly half of all bits are set
+  unsigned ones = 0;
+  for (int i = 0; i < 100; i++) {
+    ones += uint256_popcount(vals[i]);
+  }
+  ASSERT(ones > 12000 && ones < 13600);
+}
+
+void test_random_below(TestObjs *objs) {
+  UInt256Rng rng;
+  uint256_rng_seed(&rng, 42U);
+
+  // every value below a small bound shows up
+  unsigned counts[10] = { 0 };
+  UInt256 ten = uint256_create_from_u32(10U);
+  for (int i = 0; i < 1000; i++) {
+    UInt256 val = uint256_random_below(&rng, ten);
+    ASSERT(uint256_compare(val, ten) < 0);
+    counts[val.data[0]]++;
+  }
+  for (int i = 0; i < 10; i++) {
+    ASSERT(counts[i] > 50);
+  }
+
+  // bounds just above a power of two, and spanning several limbs
+  UInt256 bounds[3] = { objs->wild, uint256_shift_left(objs->one, 200), objs->max };
+  bounds[1].data[0] = 1U;
+  for (int b = 0; b < 3; b++) {
+    for (int i = 0; i < 200; i++) {
+      ASSERT(uint256_compare(uint256_random_below(&rng, bounds[b]), bounds[b]) < 0);
+    }
+  }
+
+  ASSERT_SAME(objs->zero, uint256_random_below(&rng, objs->one));
+  // 0 means no bound
+  ASSERT(uint256_bit_length(uint256_random_below(&rng, objs->zero)) > 200);
+}
+
+void test_to_double(TestObjs *objs) {
+  UInt256 one = objs->one;
+  ASSERT(0.0 == uint256_to_double(objs->zero));
+  ASSERT(1.0 == uint256_to_double(one));
+  ASSERT(0x1p255 == uint256_to_double(uint256_shift_left(one, 255)));
+
+  // halfway cases round to even; anything above halfway rounds up
+  UInt256 val = uint256_add(uint256_shift_left(one, 53), one);
+  ASSERT(0x1p53 == uint256_to_double(val));
+  val = uint256_add(val, uint256_create_from_u32(2U));
+  ASSERT(0x1p53 + 4.0 == uint256_to_double(val));
+  val = uint256_add(uint256_shift_left(one, 64), uint256_create_from_u32(0x800U));
+  ASSERT(0x1p64 == uint256_to_double(val));
+  // the lowest bit decides, even though it's not in the top 64 bits
+  val = uint256_add(val, one);
+  ASSERT(0x1p64 + 0x1p12 == uint256_to_double(val));
+
+  ASSERT(0x1p256 == uint256_to_double(objs->max));
+  val = uint256_negate(uint256_shift_left(one, 202));
+  ASSERT(0x1p256 == uint256_to_double(val));
+  val = uint256_sub(val, one);
+  ASSERT(0x1.fffffffffffffp255 == uint256_to_double(val));
+}
+
+void test_from_double(TestObjs *objs) {
+  ASSERT_SAME(objs->zero, uint256_from_double(0.0));
+  ASSERT_SAME(objs->zero, uint256_from_double(0.75));
+  ASSERT_SAME(objs->zero, uint256_from_double(-5.0));
+  ASSERT_SAME(objs->zero, uint256_from_double(0.0 / 0.0));
+  ASSERT_SAME(objs->one, uint256_from_double(1.5));
+  ASSERT_SAME(uint256_create_from_u32(123U), uint256_from_double(123.9));
+
+  UInt256 val = uint256_create_from_hex("de0b6b3a7640000");   // 10^18
+  ASSERT_SAME(val, uint256_from_double(1e18));
+  val = uint256_shift_left(uint256_create_from_hex("1fffffffffffff"), 203);
+  ASSERT_SAME(val, uint256_from_double(0x1.fffffffffffffp255));
+  ASSERT(0x1.fffffffffffffp255 == uint256_to_double(val));
+
+  ASSERT_SAME(objs->max, uint256_from_double(0x1p256));
+  ASSERT_SAME(objs->max, uint256_from_double(1e300));
+  ASSERT_SAME(objs->max, uint256_from_double(1.0 / 0.0));
+}
+
+void test_scale_pow10(TestObjs *objs) {
+  UInt256 rem, result;
+  UInt256 ten = uint256_create_from_u32(10U);
+  UInt256 vals[4] = { objs->max, objs->wild, objs->one, uint256_create_from_u32(999U) };
+
+  for (int i = 0; i < 4; i++) {
+    UInt256 power = objs->one;
+    for (unsigned k = 0; k <= 77; k++) {
+      UInt256 expectedRem;
+      UInt256 expected = uint256_divmod(vals[i], power, &expectedRem);
+      UInt256 quotient = uint256_scale_down_pow10(vals[i], k, &rem);
+      ASSERT_SAME(expected, quotient);
+      ASSERT_SAME(expectedRem, rem);
+
+      // scaling back up, plus the remainder, gives the value again
+      ASSERT(uint256_scale_up_pow10(quotient, k, &result));
+      ASSERT_SAME(vals[i], uint256_add(result, rem));
+      power = uint256_mul(power, ten);
+    }
+    ASSERT_SAME(objs->zero, uint256_scale_down_pow10(vals[i], 78, &rem));
+    ASSERT_SAME(vals[i], rem);
+  }
+
+  // 18 decimal places, as for token amounts
+  UInt256 amount = uint256_create_from_hex("3635c9adc5dea00000");   // 1000 * 10^18
+  ASSERT_SAME(uint256_create_from_u32(1000U), uint256_scale_down_pow10(amount, 18, NULL));
+
+  // overflow is detected
+  ASSERT(uint256_scale_up_pow10(objs->one, 77, &result));
+  ASSERT(!uint256_scale_up_pow10(objs->one, 78, &result));
+  ASSERT(!uint256_scale_up_pow10(objs->max, 1, &result));
+  ASSERT(uint256_scale_up_pow10(objs->zero, 100, &result));
+  ASSERT_SAME(objs->zero, result);
+}
+
+void test_from_sha256(TestObjs *objs) {
+  (void) objs;
+  UInt256 expected = uint256_create_from_hex("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+  UInt256 digest = uint256_from_sha256("", 0);
+  ASSERT_SAME(expected, digest);
+  expected = uint256_create_from_hex("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+  digest = uint256_from_sha256("abc", 3);
+  ASSERT_SAME(expected, digest);
+
+  // messages around the block and padding boundaries
+  unsigned char msg[1000];
+  for (int i = 0; i < 1000; i++) {
+    msg[i] = (unsigned char) (i * 7 + 3);
+  }
+  size_t lens[4] = { 55, 56, 64, 1000 };
+  const char *hashes[4] = {
+    "e7313d333c272e639f790978283f9eb392e843d0f29b7016828bb1daa4aac70b",
+    "4324d65f3c103567f5589c710bc08f8523f929a9272e3af36fc968e52abc6c27",
+    "39e3d7b6b5d075d37d053ad89b24b41bef4f3c29760c84447cab3f3be1882241",
+    "1e9bc38cbf860b9ec31918b065f9b52476c549a782e0e7990bed8ce3868d2371",
+  };
+  for (int i = 0; i < 4; i++) {
+    expected = uint256_create_from_hex(hashes[i]);
+    digest = uint256_from_sha256(msg, lens[i]);
+    ASSERT_SAME(expected, digest);
+  }
+
+  // a batch of messages of different lengths matches hashing each one
+  const void *batch[19];
+  size_t batchLens[19];
+  UInt256 digests[19];
+  for (int i = 0; i < 19; i++) {
+    batch[i] = msg + i;
+    batchLens[i] = (size_t) (i * 53) % 300;
+  }
+  uint256_from_sha256_batch(batch, batchLens, 19, digests);
+  for (int i = 0; i < 19; i++) {
+    expected = uint256_from_sha256(batch[i], batchLens[i]);
+    ASSERT_SAME(expected, digests[i]);
+  }
+}
+
+void test_from_keccak256(TestObjs *objs) {
+  (void) objs;
+  UInt256 expected = uint256_create_from_hex("c5d2460186f7233c927e7db2dcc703c0e500b653ca82273b7bfad8045d85a470");
+  UInt256 digest = uint256_from_keccak256("", 0);
+  ASSERT_SAME(expected, digest);
+  expected = uint256_create_from_hex("4e03657aea45a94fc7d47ba826c8d667c0d1e6e33a64a036ec44f58fa12d6c45");
+  digest = uint256_from_keccak256("abc", 3);
+  ASSERT_SAME(expected, digest);
+
+  // a batch spanning several rate-sized (136-byte) blocks
+  unsigned char msg[1000];
+  for (int i = 0; i < 1000; i++) {
+    msg[i] = (unsigned char) (i * 7 + 3);
+  }
+  const void *batch[11];
+  size_t batchLens[11];
+  UInt256 digests[11];
+  for (int i = 0; i < 11; i++) {
+    batch[i] = msg + i;
+    batchLens[i] = (size_t) (i * 67) % 500;
+  }
+  uint256_from_keccak256_batch(batch, batchLens, 11, digests);
+  for (int i = 0; i < 11; i++) {
+    expected = uint256_from_keccak256(batch[i], batchLens[i]);
+    ASSERT_SAME(expected, digests[i]);
+  }
+}
+
+// Callback for the executor tests: counts completed jobs
+static void count_job(void *arg) {
+  __atomic_fetch_add((int *) arg, 1, __ATOMIC_SEQ_CST);
+}
+
+// Range function for the executor tests: squares each index into ctx
+static void square_range(void *ctx, size_t begin, size_t end) {
+  UInt256 *out = ctx;
+  for (size_t i = begin; i < end; i++) {
+    out[i] = uint256_mul(uint256_create_from_u32((uint32_t) i), uint256_create_from_u32((uint32_t) i));
+  }
+}
+
+void test_executor_jobs(TestObjs *objs) {
+  UInt256Executor *exec = uint256_executor_create(3);
+  ASSERT(exec != NULL);
+  int completed = 0;
+
+  size_t n = 100000;
+  UInt256 *vals = malloc(n * sizeof(UInt256));
+  for (size_t i = 0; i < n; i++) {
+    vals[i] = uint256_rotate_left(objs->wild, (unsigned) i);
+  }
+  UInt256 sum;
+  UInt256Job *job = uint256_executor_submit_sum(exec, vals, n, &sum, count_job, &completed);
+  ASSERT(job != NULL);
+  uint256_job_wait(job);
+  ASSERT(1 == completed);   // the callback runs before the job is done
+  UInt256 expected = uint256_sum(vals, n);
+  ASSERT_SAME(expected, sum);
+
+  // modular exponentiation, spread over many small tiles
+  UInt256 m = uint256_create_from_hex("7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed");
+  UInt256 exps[100], out[100];
+  for (int i = 0; i < 100; i++) {
+    exps[i] = uint256_create_from_u32((uint32_t) (i * 7919));
+  }
+  job = uint256_executor_submit_mod_pow(exec, vals, exps, 100, m, out, NULL, NULL);
+  uint256_job_wait(job);
+  for (int i = 0; i < 100; i++) {
+    expected = uint256_mod_pow(vals[i], exps[i], m);
+    ASSERT_SAME(expected, out[i]);
+  }
+
+  const char *hex[3] = { "0", "ff", "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff" };
+  job = uint256_executor_submit_parse_hex(exec, hex, 3, out, NULL, NULL);
+  uint256_job_wait(job);
+  ASSERT_SAME(objs->zero, out[0]);
+  ASSERT_SAME(uint256_create_from_u32(0xffU), out[1]);
+  ASSERT_SAME(objs->max, out[2]);
+
+  // an empty job completes straight away
+  job = uint256_executor_submit_sum(exec, vals, 0, &sum, count_job, &completed);
+  ASSERT(uint256_job_done(job));
+  uint256_job_wait(job);
+  ASSERT_SAME(objs->zero, sum);
+  ASSERT(2 == completed);
+
+  uint256_executor_destroy(exec);
+  free(vals);
+}
+
+void test_executor_concurrent_jobs(TestObjs *objs) {
+  (void) objs;
+  UInt256Executor *exec = uint256_executor_create(0);
+  ASSERT(exec != NULL);
+  int completed = 0;
+
+  // many generic jobs at once, some detached (destroy waits for them)
+  size_t n = 5000;
+  UInt256 *results[8];
+  UInt256Job *jobs[8];
+  for (int j = 0; j < 8; j++) {
+    results[j] = malloc(n * sizeof(UInt256));
+    jobs[j] = uint256_executor_submit_for(exec, n, 64 + j, square_range, results[j], count_job, &completed);
+    ASSERT(jobs[j] != NULL);
+    if (j % 2) {
+      uint256_job_detach(jobs[j]);
+    }
+  }
+  for (int j = 0; j < 8; j += 2) {
+    uint256_job_wait(jobs[j]);
+  }
+  uint256_executor_destroy(exec);
+  ASSERT(8 == completed);
+
+  for (int j = 0; j < 8; j++) {
+    for (size_t i = 0; i < n; i++) {
+      ASSERT(0 == uint256_compare(uint256_mul(uint256_create_from_u32((uint32_t) i),
+                                              uint256_create_from_u32((uint32_t) i)), results[j][i]));
+    }
+    free(results[j]);
+  }
+}
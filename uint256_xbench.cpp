@@ -0,0 +1,542 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include "uint256.h"
+
+// Cross-implementation benchmark: runs the same randomized workloads
+// through this library, GMP (if built with UINT256_XBENCH_GMP, see the
+// Makefile's bench-compare target) and Boost.Multiprecision's uint256_t
+// (if its headers are available). Every implementation's results are
+// checked against this library's, and a table of ns/op and speedups
+// (other implementation's time / ours, so > 1 means we're faster) is
+// printed.
+//
+// Each operation is run many times, interleaved with the others, and
+// the median ns/op is reported along with the spread (interquartile
+// range) of the runs. Each run repeats the operation loop for at least
+// MIN_SAMPLE_NS, so that short loops aren't dominated by timer and
+// scheduling noise.
+//
+// The baseline file holds the whole table from an earlier run. If it
+// exists, an operation is flagged as regressed if its median is more
+// than 5% slower than its baseline median AND the slowdown is larger
+// than the margin of the two medians' 95% confidence intervals
+// (1.58 * IQR / sqrt(repetitions) each, as in a notched box plot), so
+// ordinary timing noise isn't reported but the margin shrinks as
+// repetitions are added. If the file doesn't exist (or -u is given),
+// the current table is written to it instead.
+//
+// -t checks the gate itself: this run is compared against its own
+// timings scaled by SELF_TEST_SCALE (a 7.5% slowdown), and every
+// operation must be flagged.
+//
+// Usage: uint256_xbench [-n num_values] [-r repetitions] [-b baseline_file] [-u] [-t]
+//
+// Exits with status 1 if any results disagree, (without -u) any
+// operation regressed, or (with -t) any operation was not flagged.
+
+#if __has_include(<boost/multiprecision/cpp_int.hpp>)
+#define XBENCH_BOOST 1
+#include <boost/multiprecision/cpp_int.hpp>
+#include <boost/integer/common_factor_rt.hpp>
+#endif
+
+#ifdef UINT256_XBENCH_GMP
+#include <gmp.h>
+#endif
+
+#define DEFAULT_NUM_VALUES 100000
+#define DEFAULT_BASELINE "bench_baseline.txt"
+#define REGRESSION_THRESHOLD 0.05
+#define DEFAULT_REPETITIONS 201
+#define MIN_SAMPLE_NS 2e6
+#define MEDIAN_CI_FACTOR 1.58
+#define SELF_TEST_SCALE 0.93
+#define XBENCH_SEED 0x5eed5eed5eedU
+
+enum { IMPL_UINT256, IMPL_BOOST, IMPL_GMP, NUM_IMPLS };
+
+static const char *implNames[NUM_IMPLS] = { "uint256", "boost", "gmp" };
+
+enum Op { OP_ADD, OP_SUB, OP_MUL, OP_DIVMOD, OP_MULMOD, OP_MOD_POW, OP_ISQRT, OP_GCD, NUM_OPS };
+
+typedef struct {
+  const char *name;
+  unsigned divideN;   // run on n / divideN values (for slow operations)
+} OpInfo;
+
+static const OpInfo ops[NUM_OPS] = {
+  { "add", 1 },
+  { "sub", 1 },
+  { "mul", 1 },
+  { "divmod", 10 },
+  { "mulmod", 10 },
+  { "mod_pow", 10000 },
+  { "isqrt", 100 },
+  { "gcd", 1000 },
+};
+
+// Operands for every operation: a[i] and b[i], a divisor derived from
+// b[i] (about half as wide as a[i], and never 0), and a fixed modulus
+static std::vector<UInt256> a, b, divisors;
+static UInt256 modulus;
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+//
+// This library
+//
+
+// Each run_* function runs op on the first n operands, returning the
+// time taken in ns and storing the results in out (unless out is NULL,
+// when only the time is wanted). Only the operation loop is timed, not
+// converting operands or results.
+
+static double run_uint256(Op op, size_t n, UInt256 *out) {
+  std::vector<UInt256> scratch;
+  if (out == NULL) {
+    scratch.resize(n);
+    out = scratch.data();
+  }
+  double start = now_ns();
+  for (size_t i = 0; i < n; i++) {
+    switch (op) {
+    case OP_ADD: out[i] = uint256_add(a[i], b[i]); break;
+    case OP_SUB: out[i] = uint256_sub(a[i], b[i]); break;
+    case OP_MUL: out[i] = uint256_mul(a[i], b[i]); break;
+    case OP_DIVMOD: out[i] = uint256_divmod(a[i], divisors[i], NULL); break;
+    case OP_MULMOD: out[i] = uint256_mulmod(a[i], b[i], modulus); break;
+    case OP_MOD_POW: out[i] = uint256_mod_pow(a[i], b[i], modulus); break;
+    case OP_ISQRT: out[i] = uint256_isqrt(a[i]); break;
+    case OP_GCD: out[i] = uint256_gcd(a[i], b[i]); break;
+    default: break;
+    }
+  }
+  return now_ns() - start;
+}
+
+//
+// Boost.Multiprecision
+//
+
+#ifdef XBENCH_BOOST
+using boost::multiprecision::uint256_t;
+using boost::multiprecision::uint512_t;
+
+static uint256_t to_boost(UInt256 val) {
+  uint256_t result = 0;
+  for (int i = 7; i >= 0; i--) {
+    result = (result << 32) | val.data[i];
+  }
+  return result;
+}
+
+static UInt256 from_boost(const uint256_t &val) {
+  UInt256 result;
+  for (int i = 0; i < 8; i++) {
+    result.data[i] = static_cast<uint32_t>(val >> (32 * i));
+  }
+  return result;
+}
+
+static double run_boost(Op op, size_t n, UInt256 *out) {
+  static std::vector<uint256_t> ba, bb, bd;
+  if (ba.size() != a.size()) {
+    ba.clear();
+    bb.clear();
+    bd.clear();
+    for (size_t i = 0; i < a.size(); i++) {
+      ba.push_back(to_boost(a[i]));
+      bb.push_back(to_boost(b[i]));
+      bd.push_back(to_boost(divisors[i]));
+    }
+  }
+  uint256_t m = to_boost(modulus);
+  std::vector<uint256_t> results(n);
+
+  double start = now_ns();
+  for (size_t i = 0; i < n; i++) {
+    switch (op) {
+    case OP_ADD: results[i] = ba[i] + bb[i]; break;
+    case OP_SUB: results[i] = ba[i] - bb[i]; break;
+    case OP_MUL: results[i] = ba[i] * bb[i]; break;
+    case OP_DIVMOD: results[i] = ba[i] / bd[i]; break;
+    case OP_MULMOD: results[i] = static_cast<uint256_t>(uint512_t(ba[i]) * bb[i] % m); break;
+    case OP_MOD_POW: results[i] = boost::multiprecision::powm(ba[i], bb[i], m); break;
+    case OP_ISQRT: results[i] = boost::multiprecision::sqrt(ba[i]); break;
+    case OP_GCD: results[i] = boost::integer::gcd(ba[i], bb[i]); break;
+    default: break;
+    }
+  }
+  double elapsed = now_ns() - start;
+
+  for (size_t i = 0; out != NULL && i < n; i++) {
+    out[i] = from_boost(results[i]);
+  }
+  return elapsed;
+}
+#endif
+
+//
+// GMP (mpn for the fixed-size operations, mpz for the others)
+//
+
+#ifdef UINT256_XBENCH_GMP
+#define GMP_LIMBS (256 / GMP_NUMB_BITS)
+
+static void to_mpz(mpz_t z, UInt256 val) {
+  mpz_import(z, 8, -1, sizeof(uint32_t), 0, 0, val.data);
+}
+
+static UInt256 from_mpz(const mpz_t z) {
+  UInt256 result;
+  memset(&result, 0, sizeof(result));
+  mpz_t low;
+  mpz_init(low);
+  mpz_fdiv_r_2exp(low, z, 256);   // wrap modulo 2^256, like uint256_*
+  mpz_export(result.data, NULL, -1, sizeof(uint32_t), 0, 0, low);
+  mpz_clear(low);
+  return result;
+}
+
+static void to_limbs(mp_limb_t *limbs, UInt256 val) {
+  mpz_t z;
+  mpz_init(z);
+  to_mpz(z, val);
+  for (int i = 0; i < GMP_LIMBS; i++) {
+    limbs[i] = mpz_getlimbn(z, i);
+  }
+  mpz_clear(z);
+}
+
+static UInt256 from_limbs(const mp_limb_t *limbs) {
+  mpz_t z;
+  mpz_init(z);
+  mpz_import(z, GMP_LIMBS, -1, sizeof(mp_limb_t), 0, 0, limbs);
+  UInt256 result = from_mpz(z);
+  mpz_clear(z);
+  return result;
+}
+
+static double run_gmp(Op op, size_t n, UInt256 *out) {
+  static std::vector<mp_limb_t> la, lb, ld;
+  static std::vector<mp_size_t> dsize;
+  static mpz_t *za, *zb, *zr;
+  static size_t prepared;
+  if (prepared != a.size()) {
+    size_t count = a.size();
+    la.assign(count * GMP_LIMBS, 0);
+    lb.assign(count * GMP_LIMBS, 0);
+    ld.assign(count * GMP_LIMBS, 0);
+    dsize.assign(count, 0);
+    za = static_cast<mpz_t *>(malloc(count * sizeof(mpz_t)));
+    zb = static_cast<mpz_t *>(malloc(count * sizeof(mpz_t)));
+    zr = static_cast<mpz_t *>(malloc(count * sizeof(mpz_t)));
+    for (size_t i = 0; i < count; i++) {
+      to_limbs(&la[i * GMP_LIMBS], a[i]);
+      to_limbs(&lb[i * GMP_LIMBS], b[i]);
+      to_limbs(&ld[i * GMP_LIMBS], divisors[i]);
+      // mpn division needs the divisor's exact size (top limb nonzero)
+      mp_size_t size = GMP_LIMBS;
+      while (size > 1 && ld[i * GMP_LIMBS + size - 1] == 0) {
+        size--;
+      }
+      dsize[i] = size;
+      mpz_init(za[i]);
+      mpz_init(zb[i]);
+      mpz_init2(zr[i], 512);
+      to_mpz(za[i], a[i]);
+      to_mpz(zb[i], b[i]);
+    }
+    prepared = count;
+  }
+
+  std::vector<mp_limb_t> results(n * GMP_LIMBS, 0);
+  mpz_t m, t;
+  mpz_init(m);
+  mpz_init2(t, 512);
+  to_mpz(m, modulus);
+
+  double start = now_ns();
+  for (size_t i = 0; i < n; i++) {
+    mp_limb_t *res = &results[i * GMP_LIMBS];
+    const mp_limb_t *x = &la[i * GMP_LIMBS];
+    const mp_limb_t *y = &lb[i * GMP_LIMBS];
+    switch (op) {
+    case OP_ADD: mpn_add_n(res, x, y, GMP_LIMBS); break;
+    case OP_SUB: mpn_sub_n(res, x, y, GMP_LIMBS); break;
+    case OP_MUL: {
+      // GMP has no public low-half product, so this is the full product
+      mp_limb_t product[2 * GMP_LIMBS];
+      mpn_mul_n(product, x, y, GMP_LIMBS);
+      memcpy(res, product, GMP_LIMBS * sizeof(mp_limb_t));
+      break;
+    }
+    case OP_DIVMOD: {
+      mp_limb_t rem[GMP_LIMBS];
+      mpn_tdiv_qr(res, rem, 0, x, GMP_LIMBS, &ld[i * GMP_LIMBS], dsize[i]);
+      break;
+    }
+    case OP_MULMOD:
+      mpz_mul(t, za[i], zb[i]);
+      mpz_mod(zr[i], t, m);
+      break;
+    case OP_MOD_POW: mpz_powm(zr[i], za[i], zb[i], m); break;
+    case OP_ISQRT: mpz_sqrt(zr[i], za[i]); break;
+    case OP_GCD: mpz_gcd(zr[i], za[i], zb[i]); break;
+    default: break;
+    }
+  }
+  double elapsed = now_ns() - start;
+
+  for (size_t i = 0; out != NULL && i < n; i++) {
+    out[i] = op >= OP_MULMOD ? from_mpz(zr[i]) : from_limbs(&results[i * GMP_LIMBS]);
+  }
+  mpz_clear(m);
+  mpz_clear(t);
+  return elapsed;
+}
+#endif
+
+// Return the function that runs an implementation, or NULL if it
+// wasn't built in.
+static double (*impl_runner(int impl))(Op, size_t, UInt256 *) {
+  if (impl == IMPL_UINT256) {
+    return run_uint256;
+  }
+#ifdef XBENCH_BOOST
+  if (impl == IMPL_BOOST) {
+    return run_boost;
+  }
+#endif
+#ifdef UINT256_XBENCH_GMP
+  if (impl == IMPL_GMP) {
+    return run_gmp;
+  }
+#endif
+  return NULL;
+}
+
+// Median and interquartile range of an operation's ns/op over all of
+// its repetitions (median is -1 if the implementation is unavailable)
+typedef struct {
+  double median;
+  double spread;
+  int reps;
+} Timing;
+
+static Timing summarize(std::vector<double> &samples) {
+  Timing timing = { -1.0, 0.0, 0 };
+  if (!samples.empty()) {
+    std::sort(samples.begin(), samples.end());
+    size_t n = samples.size();
+    timing.median = samples[n / 2];
+    timing.spread = samples[n * 3 / 4] - samples[n / 4];
+    timing.reps = (int) n;
+  }
+  return timing;
+}
+
+// Half-width of the 95% confidence interval of a timing's median,
+// relative to the median
+static double median_margin(const Timing &timing) {
+  return MEDIAN_CI_FACTOR * timing.spread / sqrt((double) timing.reps) / timing.median;
+}
+
+// Print a table row (the agree column excepted) for one operation
+static void print_row(FILE *out, const char *name, const Timing *timings) {
+  const Timing &ours = timings[IMPL_UINT256];
+  fprintf(out, "%-8s %10.2f %8.2f %5d", name, ours.median, ours.spread, ours.reps);
+  for (int impl = IMPL_BOOST; impl < NUM_IMPLS; impl++) {
+    if (timings[impl].median >= 0.0) {
+      fprintf(out, " %10.2f %7.2fx", timings[impl].median, timings[impl].median / ours.median);
+    } else {
+      fprintf(out, " %10s %8s", "-", "-");
+    }
+  }
+}
+
+// Read our timings from the baseline file into op name -> timing (empty
+// if it doesn't exist). Each line is a row of the table as written by
+// print_row: "name median spread repetitions" followed by the other
+// implementations' columns (all times in ns/op).
+static std::map<std::string, Timing> read_baseline(const char *path) {
+  std::map<std::string, Timing> baseline;
+  FILE *in = fopen(path, "r");
+  if (in == NULL) {
+    return baseline;
+  }
+  char line[256], name[64];
+  Timing timing;
+  while (fgets(line, sizeof(line), in)) {
+    if (line[0] != '#' && sscanf(line, "%63s %lf %lf %d", name, &timing.median, &timing.spread, &timing.reps) == 4 &&
+        timing.reps > 0) {
+      baseline[name] = timing;
+    }
+  }
+  fclose(in);
+  return baseline;
+}
+
+int main(int argc, char **argv) {
+  size_t n = DEFAULT_NUM_VALUES;
+  const char *baselinePath = DEFAULT_BASELINE;
+  int reps = DEFAULT_REPETITIONS;
+  int updateBaseline = 0;
+  int selfTest = 0;
+  int opt;
+  while ((opt = getopt(argc, argv, "n:r:b:ut")) != -1) {
+    switch (opt) {
+    case 'n': n = strtoul(optarg, NULL, 10); break;
+    case 'r': reps = atoi(optarg) > 0 ? atoi(optarg) : 1; break;
+    case 'b': baselinePath = optarg; break;
+    case 'u': updateBaseline = 1; break;
+    case 't': selfTest = 1; break;
+    default:
+      fprintf(stderr, "Usage: %s [-n num_values] [-r repetitions] [-b baseline_file] [-u] [-t]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  UInt256Rng rng;
+  uint256_rng_seed(&rng, XBENCH_SEED);
+  a.resize(n);
+  b.resize(n);
+  divisors.resize(n);
+  uint256_random_fill(&rng, a.data(), n);
+  uint256_random_fill(&rng, b.data(), n);
+  for (size_t i = 0; i < n; i++) {
+    divisors[i] = uint256_shift_right(b[i], 128);
+    divisors[i].data[0] |= 1U;
+  }
+  modulus = uint256_create_from_hex("7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed");
+
+  std::map<std::string, Timing> baseline;
+  if (!selfTest) {
+    baseline = read_baseline(baselinePath);
+  }
+  int writeBaseline = !selfTest && (updateBaseline || baseline.empty());
+  std::vector<UInt256> expected(n), results(n);
+  size_t counts[NUM_OPS];
+  size_t loops[NUM_OPS][NUM_IMPLS];
+  int agree[NUM_OPS];
+  int failures = 0;
+
+  // check every implementation against ours (this also warms up their
+  // caches and allocations before timing), and work out how many times
+  // each one's loop must run to fill MIN_SAMPLE_NS
+  for (int op = 0; op < NUM_OPS; op++) {
+    counts[op] = n / ops[op].divideN > 0 ? n / ops[op].divideN : (n > 0 ? 1 : 0);
+    agree[op] = 1;
+    for (int impl = 0; impl < NUM_IMPLS; impl++) {
+      if (impl_runner(impl) == NULL) {
+        continue;
+      }
+      double elapsed = impl_runner(impl)((Op) op, counts[op], impl == IMPL_UINT256 ? expected.data() : results.data());
+      loops[op][impl] = elapsed < MIN_SAMPLE_NS ? (size_t) ceil(MIN_SAMPLE_NS / std::max(elapsed, 1.0)) : 1;
+      if (impl == IMPL_UINT256) {
+        continue;
+      }
+      for (size_t i = 0; i < counts[op]; i++) {
+        if (uint256_compare(expected[i], results[i]) != 0) {
+          agree[op] = 0;
+          break;
+        }
+      }
+    }
+  }
+
+  // Time each repetition of every operation and implementation in turn,
+  // so each one's samples are spread over the whole run rather than
+  // bunched into one stretch of it that a noisy neighbor or a clock
+  // change could skew
+  std::vector<double> samples[NUM_OPS][NUM_IMPLS];
+  for (int rep = 0; rep < reps; rep++) {
+    for (int op = 0; op < NUM_OPS; op++) {
+      for (int impl = 0; impl < NUM_IMPLS && counts[op] > 0; impl++) {
+        if (impl_runner(impl) == NULL) {
+          continue;
+        }
+        double elapsed = 0.0;
+        for (size_t loop = 0; loop < loops[op][impl]; loop++) {
+          elapsed += impl_runner(impl)((Op) op, counts[op], NULL);
+        }
+        samples[op][impl].push_back(elapsed / (loops[op][impl] * counts[op]));
+      }
+    }
+  }
+
+  Timing timings[NUM_OPS][NUM_IMPLS];
+  for (int op = 0; op < NUM_OPS; op++) {
+    for (int impl = 0; impl < NUM_IMPLS; impl++) {
+      timings[op][impl] = summarize(samples[op][impl]);
+    }
+    if (selfTest) {
+      Timing scaled = timings[op][IMPL_UINT256];
+      scaled.median *= SELF_TEST_SCALE;
+      scaled.spread *= SELF_TEST_SCALE;
+      baseline[ops[op].name] = scaled;
+    }
+  }
+
+  printf("%-8s %10s %8s %5s %10s %8s %10s %8s %7s %10s %8s %7s\n", "op", "uint256", "spread", "reps",
+         implNames[IMPL_BOOST], "x", implNames[IMPL_GMP], "x", "agree", "baseline", "change", "margin");
+  for (int op = 0; op < NUM_OPS; op++) {
+    const Timing &now = timings[op][IMPL_UINT256];
+    print_row(stdout, ops[op].name, timings[op]);
+    printf(" %7s", agree[op] ? "yes" : "NO");
+    if (!agree[op]) {
+      failures++;
+    }
+
+    int regressed = 0;
+    auto base = baseline.find(ops[op].name);
+    if (base != baseline.end() && base->second.median > 0.0 && now.median > 0.0) {
+      double change = now.median / base->second.median - 1.0;
+      double margin = hypot(median_margin(now), median_margin(base->second));
+      printf(" %10.2f %+7.1f%% %6.1f%%", base->second.median, 100.0 * change, 100.0 * margin);
+      regressed = change > REGRESSION_THRESHOLD && change > margin;
+      if (regressed) {
+        printf("  REGRESSED");
+        // -u accepts the new timings
+        failures += !updateBaseline && !selfTest;
+      }
+    }
+    if (selfTest && !regressed) {
+      printf("  NOT FLAGGED");
+      failures++;
+    }
+    printf("\n");
+  }
+
+  if (writeBaseline) {
+    FILE *out = fopen(baselinePath, "w");
+    if (out == NULL) {
+      fprintf(stderr, "Error: could not write %s\n", baselinePath);
+      return 1;
+    }
+    fprintf(out, "# median and spread (interquartile range) in ns/op over %d repetitions of %zu values,\n"
+                 "# with each implementation's speedup over uint256 (> 1 means uint256 is faster),\n"
+                 "# written by uint256_xbench\n", reps, n);
+    fprintf(out, "# %-6s %10s %8s %5s %10s %8s %10s %8s\n", "op", "uint256", "spread", "reps",
+            implNames[IMPL_BOOST], "x", implNames[IMPL_GMP], "x");
+    for (int op = 0; op < NUM_OPS; op++) {
+      print_row(out, ops[op].name, timings[op]);
+      fprintf(out, "\n");
+    }
+    fclose(out);
+    printf("baseline written to %s\n", baselinePath);
+  }
+  return failures > 0;
+}